@@ -0,0 +1,85 @@
+#include "app/autosave_scheduler.hpp"
+
+#include <QTimer>
+
+namespace Jino::App {
+
+namespace {
+constexpr int CHECK_INTERVAL_MS = 500;
+constexpr qint64 IDLE_DEBOUNCE_MS = 2000;
+constexpr qint64 MAX_STALENESS_MS = 30000;
+} // namespace
+
+AutosaveScheduler::AutosaveScheduler(QObject *parent)
+    : QObject(parent), checkTimer(new QTimer(this)) {
+  clock.start();
+  checkTimer->setInterval(CHECK_INTERVAL_MS);
+  connect(checkTimer, &QTimer::timeout, this,
+          &AutosaveScheduler::checkBuffers);
+}
+
+void AutosaveScheduler::markDirty(QWidget *buffer) {
+  BufferState &state = buffers[buffer];
+  const qint64 now = clock.elapsed();
+  if (state.firstDirtyMs < 0)
+    state.firstDirtyMs = now;
+  state.lastEditMs = now;
+  if (!checkTimer->isActive())
+    checkTimer->start();
+}
+
+void AutosaveScheduler::markPersisted(QWidget *buffer, bool upToDate) {
+  BufferState &state = buffers[buffer];
+  state.inFlight = false;
+  state.lastPersistMs = clock.elapsed();
+  if (upToDate) {
+    state.firstDirtyMs = -1;
+    state.lastEditMs = -1;
+  }
+}
+
+void AutosaveScheduler::markPersistFailed(QWidget *buffer) {
+  auto it = buffers.find(buffer);
+  if (it == buffers.end())
+    return;
+  // Wait a full staleness period before trying again.
+  it->inFlight = false;
+  it->firstDirtyMs = clock.elapsed();
+  it->lastEditMs = it->firstDirtyMs;
+}
+
+void AutosaveScheduler::forget(QWidget *buffer) { buffers.remove(buffer); }
+
+bool AutosaveScheduler::isDirty(QWidget *buffer) const {
+  return buffers.value(buffer).firstDirtyMs >= 0;
+}
+
+qint64 AutosaveScheduler::msecsSincePersist(QWidget *buffer) const {
+  const qint64 persisted = buffers.value(buffer).lastPersistMs;
+  return persisted < 0 ? -1 : clock.elapsed() - persisted;
+}
+
+void AutosaveScheduler::checkBuffers() {
+  const qint64 now = clock.elapsed();
+  bool anyDirty = false;
+  QList<QWidget *> due;
+  for (auto it = buffers.cbegin(); it != buffers.cend(); ++it) {
+    const BufferState &state = it.value();
+    if (state.firstDirtyMs < 0)
+      continue;
+    anyDirty = true;
+    if (state.inFlight)
+      continue;
+    if (now - state.lastEditMs >= IDLE_DEBOUNCE_MS ||
+        now - state.firstDirtyMs >= MAX_STALENESS_MS)
+      due << it.key();
+  }
+  if (!anyDirty)
+    checkTimer->stop();
+  for (QWidget *buffer : qAsConst(due)) {
+    buffers[buffer].inFlight = true;
+    emit persistRequested(buffer);
+  }
+}
+
+} // namespace Jino::App
@@ -0,0 +1,49 @@
+// src/app/autosave_scheduler.hpp
+#pragma once
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+
+class QTimer;
+class QWidget;
+
+namespace Jino::App {
+
+// Tracks which buffers changed since they were last persisted and asks for
+// them to be written once typing pauses, or once they have been dirty for
+// too long regardless of activity.
+class AutosaveScheduler : public QObject {
+  Q_OBJECT
+
+public:
+  explicit AutosaveScheduler(QObject *parent = nullptr);
+
+  void markDirty(QWidget *buffer);
+  void markPersisted(QWidget *buffer, bool upToDate);
+  void markPersistFailed(QWidget *buffer);
+  void forget(QWidget *buffer);
+
+  bool isDirty(QWidget *buffer) const;
+  qint64 msecsSincePersist(QWidget *buffer) const;
+
+signals:
+  void persistRequested(QWidget *buffer);
+
+private slots:
+  void checkBuffers();
+
+private:
+  struct BufferState {
+    qint64 firstDirtyMs = -1;
+    qint64 lastEditMs = -1;
+    qint64 lastPersistMs = -1;
+    bool inFlight = false;
+  };
+
+  QElapsedTimer clock;
+  QTimer *checkTimer;
+  QMap<QWidget *, BufferState> buffers;
+};
+
+} // namespace Jino::App
@@ -0,0 +1,369 @@
+#include "app/edit_journal.hpp"
+#include "core/constants.hpp"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QTextCursor>
+#include <QTextCodec>
+#include <QTextDocument>
+#include <QThreadPool>
+#include <QTimer>
+
+namespace Jino::App {
+
+namespace {
+constexpr quint32 JOURNAL_MAGIC = 0x4A4E4A4C;
+constexpr quint8 JOURNAL_VERSION = 1;
+constexpr quint8 RECORD_HEADER = 'H';
+constexpr quint8 RECORD_BASE_FILE = 'B';
+constexpr quint8 RECORD_SNAPSHOT = 'S';
+constexpr quint8 RECORD_EDIT = 'E';
+constexpr int FLUSH_INTERVAL_MS = 300;
+constexpr qint64 COMPACT_RATIO = 4;
+constexpr qint64 COMPACT_MIN_BYTES = 256 * 1024;
+
+QString readBaseFile(const QString &filePath, bool &ok) {
+  QFile base(filePath);
+  ok = base.open(QIODevice::ReadOnly);
+  if (!ok)
+    return QString();
+  QTextCodec *codec =
+      QTextCodec::codecForName(Constants::DEFAULT_FILE_ENCODING);
+  QString text = codec->toUnicode(base.readAll());
+  text.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+  text.replace(QLatin1Char('\r'), QLatin1Char('\n'));
+  return text;
+}
+
+// QTextCursor::selectedText() reports block breaks and a few other
+// characters with their Unicode stand-ins; map them back to what
+// toPlainText() would produce.
+QString toPlainTextChars(QString text) {
+  for (QChar &c : text) {
+    if (c == QChar::ParagraphSeparator || c == QChar::LineSeparator)
+      c = QLatin1Char('\n');
+    else if (c == QChar::Nbsp)
+      c = QLatin1Char(' ');
+  }
+  return text;
+}
+
+// What a rewritten journal starts from, captured on the GUI thread so the
+// background write sees the document as it was when the rewrite began.
+struct JournalStart {
+  QString filePath;
+  QString baseName;
+  bool baseFile = false;
+  qint64 baseSize = 0;
+  qint64 baseModified = 0;
+  QString text;
+};
+
+bool writeJournal(const QString &path, const JournalStart &start) {
+  QSaveFile out(path);
+  if (!out.open(QIODevice::WriteOnly)) {
+    qWarning() << "Cannot write journal:" << path << out.errorString();
+    return false;
+  }
+  QDataStream stream(&out);
+  stream.setVersion(QDataStream::Qt_5_0);
+  stream << JOURNAL_MAGIC << JOURNAL_VERSION;
+  stream << RECORD_HEADER << start.filePath << start.baseName;
+  if (start.baseFile)
+    stream << RECORD_BASE_FILE << start.baseSize << start.baseModified;
+  else
+    stream << RECORD_SNAPSHOT << start.text;
+  if (!out.commit()) {
+    qWarning() << "Cannot write journal:" << path << out.errorString();
+    return false;
+  }
+  return true;
+}
+
+class RewriteTask : public QRunnable {
+public:
+  RewriteTask(QObject *journal, quint64 generation, const QString &path,
+              const JournalStart &start,
+              QAtomicInteger<quint64> *committedGeneration)
+      : journal(journal), generation(generation), path(path), start(start),
+        committedGeneration(committedGeneration) {}
+
+  void run() override {
+    if (writeJournal(path, start))
+      committedGeneration->storeRelease(generation);
+    start.text.clear();
+    QMetaObject::invokeMethod(journal, "finishRewrite", Qt::QueuedConnection,
+                              Q_ARG(quint64, generation));
+  }
+
+private:
+  QObject *journal;
+  quint64 generation;
+  QString path;
+  JournalStart start;
+  QAtomicInteger<quint64> *committedGeneration;
+};
+} // namespace
+
+EditJournal::EditJournal(QTextDocument *document, const QString &journalPath,
+                         QObject *parent)
+    : QObject(parent), textDocument(document),
+      documentLength(document->characterCount() - 1), path(journalPath),
+      file(journalPath), lock(journalPath + ".lock"),
+      flushTimer(new QTimer(this)), pool(new QThreadPool(this)) {
+  pool->setMaxThreadCount(1);
+  pool->setExpiryTimeout(-1);
+  lock.setStaleLockTime(0);
+  if (!lock.tryLock(0))
+    qWarning() << "Journal lock is held elsewhere:" << journalPath;
+  flushTimer->setSingleShot(true);
+  flushTimer->setInterval(FLUSH_INTERVAL_MS);
+  connect(flushTimer, &QTimer::timeout, this,
+          &EditJournal::writePendingEdits);
+  connect(document, &QTextDocument::contentsChange, this,
+          &EditJournal::handleContentsChange);
+}
+
+EditJournal::~EditJournal() {
+  flush();
+  pool->waitForDone();
+}
+
+QString EditJournal::journalPath() const { return path; }
+
+void EditJournal::resetToFile(const QString &filePath,
+                              const QString &baseName) {
+  currentFilePath = filePath;
+  currentBaseName = baseName;
+  rewrite(false);
+}
+
+void EditJournal::resetToSnapshot(const QString &filePath,
+                                  const QString &baseName) {
+  currentFilePath = filePath;
+  currentBaseName = baseName;
+  rewrite(true);
+}
+
+// Captures the journal's starting point and hands the write to the pool.
+// Edits already pending are part of that starting point, so they are
+// dropped; later ones wait in pendingEdits until finishRewrite.
+void EditJournal::rewrite(bool snapshot) {
+  if (!textDocument)
+    return;
+  flushTimer->stop();
+  pendingEdits.clear();
+  if (file.isOpen())
+    file.close();
+  active = false;
+
+  JournalStart start;
+  start.filePath = currentFilePath;
+  start.baseName = currentBaseName;
+  const QFileInfo base(currentFilePath);
+  start.baseFile = !snapshot && base.exists();
+  if (start.baseFile) {
+    start.baseSize = base.size();
+    start.baseModified = base.lastModified().toMSecsSinceEpoch();
+  } else {
+    start.text = textDocument->toPlainText();
+  }
+  rewriting = true;
+  pool->start(new RewriteTask(this, ++rewriteGeneration, path, start,
+                              &committedGeneration));
+}
+
+void EditJournal::waitForRewrite() {
+  if (!rewriting)
+    return;
+  pool->waitForDone();
+  finishRewrite(rewriteGeneration);
+}
+
+// A rewrite superseded by a later one, or already finished by
+// waitForRewrite, is ignored.
+void EditJournal::finishRewrite(quint64 generation) {
+  if (!rewriting || generation != rewriteGeneration)
+    return;
+  rewriting = false;
+  if (committedGeneration.loadAcquire() != generation) {
+    pendingEdits.clear();
+    return;
+  }
+  active = file.open(QIODevice::WriteOnly | QIODevice::Append);
+  writePendingEdits();
+}
+
+// The inserted text is only read while the journal records, so a buffer
+// without one pays for nothing but the length bookkeeping.
+void EditJournal::handleContentsChange(int position, int charsRemoved,
+                                       int charsAdded) {
+  Q_UNUSED(charsRemoved);
+  if (!textDocument)
+    return;
+  // contentsChange counts can include the document's implicit final block
+  // separator, so the removed length is derived from the length delta.
+  const int oldLength = documentLength;
+  const int newLength = textDocument->characterCount() - 1;
+  documentLength = newLength;
+  if (!active && !rewriting)
+    return;
+  const int added = qBound(0, charsAdded, newLength - position);
+  const int removed = oldLength - (newLength - added);
+  if (position < 0 || removed < 0 || position + removed > oldLength) {
+    qWarning() << "Journal lost track of the document, taking a snapshot";
+    rewrite(true);
+    return;
+  }
+  QString inserted;
+  if (added > 0) {
+    QTextCursor cursor(textDocument);
+    cursor.setPosition(position);
+    cursor.setPosition(position + added, QTextCursor::KeepAnchor);
+    inserted = toPlainTextChars(cursor.selectedText());
+  }
+  recordEdit(position, removed, inserted);
+}
+
+void EditJournal::recordEdit(int position, int removed,
+                             const QString &inserted) {
+  const int added = inserted.size();
+  if (!pendingEdits.isEmpty()) {
+    PendingEdit &last = pendingEdits.last();
+    const int lastEnd = last.position + last.inserted.size();
+    if (removed == 0 && position == lastEnd) {
+      last.inserted += inserted;
+    } else if (added == 0 && removed == 1 && position == lastEnd - 1 &&
+               !last.inserted.isEmpty()) {
+      last.inserted.chop(1);
+    } else {
+      pendingEdits.append({position, removed, inserted});
+    }
+  } else {
+    pendingEdits.append({position, removed, inserted});
+  }
+  if (!flushTimer->isActive())
+    flushTimer->start();
+}
+
+void EditJournal::flush() {
+  waitForRewrite();
+  writePendingEdits();
+}
+
+void EditJournal::writePendingEdits() {
+  if (!active || pendingEdits.isEmpty())
+    return;
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_0);
+  for (const PendingEdit &edit : qAsConst(pendingEdits))
+    stream << RECORD_EDIT << qint32(edit.position) << qint32(edit.removed)
+           << edit.inserted;
+  pendingEdits.clear();
+  file.flush();
+  compactIfNeeded();
+}
+
+void EditJournal::compactIfNeeded() {
+  const qint64 documentBytes = qint64(documentLength) * 2;
+  if (file.size() > qMax(COMPACT_MIN_BYTES, documentBytes * COMPACT_RATIO))
+    rewrite(true);
+}
+
+void EditJournal::discard() {
+  flushTimer->stop();
+  pool->waitForDone();
+  pendingEdits.clear();
+  active = false;
+  rewriting = false;
+  if (file.isOpen())
+    file.close();
+  QFile::remove(path);
+  lock.unlock();
+}
+
+QStringList EditJournal::findOrphans(const QString &directory) {
+  QStringList orphans;
+  const QDir dir(directory);
+  const QStringList names = dir.entryList(
+      QStringList() << "*" + Constants::JOURNAL_FILE_SUFFIX,
+      QDir::Files | QDir::Hidden);
+  for (const QString &name : names) {
+    const QString journal = dir.filePath(name);
+    QLockFile probe(journal + ".lock");
+    probe.setStaleLockTime(0);
+    if (probe.tryLock(0)) {
+      probe.unlock();
+      orphans << journal;
+    }
+  }
+  return orphans;
+}
+
+bool EditJournal::recover(const QString &journalPath, Recovery &recovery) {
+  QFile in(journalPath);
+  if (!in.open(QIODevice::ReadOnly))
+    return false;
+  QDataStream stream(&in);
+  stream.setVersion(QDataStream::Qt_5_0);
+  quint32 magic = 0;
+  quint8 version = 0;
+  stream >> magic >> version;
+  if (stream.status() != QDataStream::Ok || magic != JOURNAL_MAGIC ||
+      version != JOURNAL_VERSION)
+    return false;
+
+  bool haveBase = false;
+  while (!stream.atEnd()) {
+    quint8 kind = 0;
+    stream >> kind;
+    if (kind == RECORD_HEADER) {
+      QString filePath, baseName;
+      stream >> filePath >> baseName;
+      if (stream.status() != QDataStream::Ok)
+        break;
+      recovery.filePath = filePath;
+      recovery.baseName = baseName;
+    } else if (kind == RECORD_BASE_FILE) {
+      qint64 size = 0, modified = 0;
+      stream >> size >> modified;
+      if (stream.status() != QDataStream::Ok)
+        break;
+      const QFileInfo base(recovery.filePath);
+      if (!base.exists() || base.size() != size ||
+          base.lastModified().toMSecsSinceEpoch() != modified) {
+        qWarning() << "Journal base file changed since it was recorded:"
+                   << recovery.filePath;
+        return false;
+      }
+      recovery.text = readBaseFile(recovery.filePath, haveBase);
+      if (!haveBase)
+        return false;
+    } else if (kind == RECORD_SNAPSHOT) {
+      QString text;
+      stream >> text;
+      if (stream.status() != QDataStream::Ok)
+        break;
+      recovery.text = text;
+      haveBase = true;
+    } else if (kind == RECORD_EDIT) {
+      qint32 position = 0, removed = 0;
+      QString inserted;
+      stream >> position >> removed >> inserted;
+      if (stream.status() != QDataStream::Ok || !haveBase || position < 0 ||
+          removed < 0 || position + removed > recovery.text.size())
+        break;
+      recovery.text.replace(position, removed, inserted);
+    } else {
+      break;
+    }
+  }
+  return haveBase;
+}
+
+} // namespace Jino::App
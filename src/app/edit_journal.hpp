@@ -0,0 +1,86 @@
+// src/app/edit_journal.hpp
+#pragma once
+
+#include <QAtomicInteger>
+#include <QFile>
+#include <QLockFile>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QTextDocument;
+class QThreadPool;
+class QTimer;
+
+namespace Jino::App {
+
+// Append-only journal of a buffer's edits. The journal starts from either
+// the file on disk or a full snapshot and then records every change as
+// (position, removed, inserted), so a buffer can be rebuilt after a crash.
+// Edits are taken from the document's contentsChange deltas; if one cannot
+// be applied to the length the journal last saw, it starts over from a
+// snapshot.
+// Records are batched and flushed on a short timer, and the journal is
+// rewritten as a single snapshot once it grows well past the document size.
+// Rewrites serialize the snapshot on a background thread; edits made while
+// one is running are held back and appended once it has been committed.
+class EditJournal : public QObject {
+  Q_OBJECT
+
+public:
+  struct Recovery {
+    QString filePath;
+    QString baseName;
+    QString text;
+  };
+
+  EditJournal(QTextDocument *document, const QString &journalPath,
+              QObject *parent = nullptr);
+  ~EditJournal() override;
+
+  QString journalPath() const;
+
+  void resetToFile(const QString &filePath, const QString &baseName);
+  void resetToSnapshot(const QString &filePath, const QString &baseName);
+  void flush();
+  void discard();
+
+  static QStringList findOrphans(const QString &directory);
+  static bool recover(const QString &journalPath, Recovery &recovery);
+
+private slots:
+  void handleContentsChange(int position, int charsRemoved, int charsAdded);
+  void finishRewrite(quint64 generation);
+
+private:
+  struct PendingEdit {
+    int position = 0;
+    int removed = 0;
+    QString inserted;
+  };
+
+  void recordEdit(int position, int removed, const QString &inserted);
+  void rewrite(bool snapshot);
+  void waitForRewrite();
+  void writePendingEdits();
+  void compactIfNeeded();
+
+  QPointer<QTextDocument> textDocument;
+  int documentLength = 0;
+  QString path;
+  QFile file;
+  QLockFile lock;
+  QTimer *flushTimer;
+  QThreadPool *pool;
+  QVector<PendingEdit> pendingEdits;
+  QString currentFilePath;
+  QString currentBaseName;
+  bool active = false;
+  bool rewriting = false;
+  quint64 rewriteGeneration = 0;
+  QAtomicInteger<quint64> committedGeneration;
+};
+
+} // namespace Jino::App
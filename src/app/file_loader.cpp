@@ -0,0 +1,162 @@
+#include "app/file_loader.hpp"
+#include "core/constants.hpp"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextCodec>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QThread>
+#include <QTimer>
+#include <memory>
+
+namespace Jino::App {
+
+namespace {
+constexpr qint64 READ_CHUNK_BYTES = 64 * 1024;
+constexpr int MAX_QUEUED_CHUNKS = 64;
+constexpr int INSERT_SLICE_MS = 8;
+} // namespace
+
+FileLoader::FileLoader(const QString &path, QTextDocument *document,
+                       QObject *parent)
+    : QObject(parent), path(path), document(document),
+      insertTimer(new QTimer(this)) {
+  insertTimer->setInterval(0);
+  connect(insertTimer, &QTimer::timeout, this,
+          &FileLoader::insertPendingChunks);
+  connect(this, &FileLoader::chunkDecoded, this,
+          &FileLoader::handleChunkDecoded, Qt::QueuedConnection);
+  connect(this, &FileLoader::readFinished, this,
+          &FileLoader::handleReadFinished, Qt::QueuedConnection);
+}
+
+FileLoader::~FileLoader() { stopWorker(); }
+
+QString FileLoader::filePath() const { return path; }
+
+int FileLoader::progressPercent() const {
+  if (totalBytes <= 0)
+    return completed ? 100 : 0;
+  return static_cast<int>(qBound<qint64>(0, insertedBytes * 100 / totalBytes,
+                                         100));
+}
+
+void FileLoader::start() {
+  if (worker || !document)
+    return;
+  totalBytes = QFileInfo(path).size();
+  document->setUndoRedoEnabled(false);
+  worker = QThread::create([this]() { readFile(); });
+  worker->start();
+}
+
+void FileLoader::cancel() {
+  stopWorker();
+  insertTimer->stop();
+  pendingChunks.clear();
+  if (document && !completed)
+    document->setUndoRedoEnabled(true);
+  completed = true;
+}
+
+void FileLoader::stopWorker() {
+  cancelRequested = true;
+  if (worker) {
+    worker->wait();
+    delete worker;
+    worker = nullptr;
+  }
+}
+
+void FileLoader::readFile() {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    emit readFinished(false);
+    return;
+  }
+  QTextCodec *codec =
+      QTextCodec::codecForName(Constants::DEFAULT_FILE_ENCODING);
+  std::unique_ptr<QTextDecoder> decoder(codec->makeDecoder());
+  qint64 bytesRead = 0;
+  QString pendingCarriageReturn;
+  while (!cancelRequested) {
+    if (queuedChunks >= MAX_QUEUED_CHUNKS) {
+      QThread::msleep(2);
+      continue;
+    }
+    const QByteArray bytes = file.read(READ_CHUNK_BYTES);
+    if (bytes.isEmpty())
+      break;
+    bytesRead += bytes.size();
+    // Hold back a trailing CR so a CRLF split across chunks is not inserted
+    // as two line breaks.
+    QString text = pendingCarriageReturn + decoder->toUnicode(bytes);
+    pendingCarriageReturn.clear();
+    if (text.endsWith(QLatin1Char('\r'))) {
+      text.chop(1);
+      pendingCarriageReturn = QStringLiteral("\r");
+    }
+    ++queuedChunks;
+    emit chunkDecoded(text, bytesRead);
+  }
+  if (!pendingCarriageReturn.isEmpty() && !cancelRequested) {
+    ++queuedChunks;
+    emit chunkDecoded(pendingCarriageReturn, bytesRead);
+  }
+  emit readFinished(file.error() == QFileDevice::NoError);
+}
+
+void FileLoader::handleChunkDecoded(const QString &text, qint64 bytesRead) {
+  if (completed)
+    return;
+  pendingChunks.enqueue({text, bytesRead});
+  if (!insertTimer->isActive())
+    insertTimer->start();
+}
+
+void FileLoader::handleReadFinished(bool ok) {
+  if (completed)
+    return;
+  readDone = true;
+  readOk = ok;
+  if (pendingChunks.isEmpty())
+    complete();
+}
+
+void FileLoader::insertPendingChunks() {
+  if (!document) {
+    cancel();
+    return;
+  }
+  QElapsedTimer slice;
+  slice.start();
+  QTextCursor cursor(document);
+  cursor.movePosition(QTextCursor::End);
+  while (!pendingChunks.isEmpty() && slice.elapsed() < INSERT_SLICE_MS) {
+    const PendingChunk chunk = pendingChunks.dequeue();
+    --queuedChunks;
+    cursor.insertText(chunk.text);
+    insertedBytes = chunk.bytesRead;
+  }
+  document->setModified(false);
+  emit progressChanged(progressPercent());
+  if (pendingChunks.isEmpty()) {
+    insertTimer->stop();
+    if (readDone)
+      complete();
+  }
+}
+
+void FileLoader::complete() {
+  stopWorker();
+  completed = true;
+  if (document) {
+    document->setUndoRedoEnabled(true);
+    document->setModified(false);
+  }
+  emit finished(readOk);
+}
+
+} // namespace Jino::App
@@ -0,0 +1,69 @@
+// src/app/file_loader.hpp
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QString>
+#include <atomic>
+
+class QTextDocument;
+class QThread;
+class QTimer;
+
+namespace Jino::App {
+
+// Reads and decodes a file on a worker thread and streams the text into a
+// document in short time slices, so the GUI stays responsive while large
+// files open.
+class FileLoader : public QObject {
+  Q_OBJECT
+
+public:
+  FileLoader(const QString &path, QTextDocument *document,
+             QObject *parent = nullptr);
+  ~FileLoader() override;
+
+  void start();
+  void cancel();
+
+  QString filePath() const;
+  int progressPercent() const;
+
+signals:
+  void progressChanged(int percent);
+  void finished(bool ok);
+
+  void chunkDecoded(const QString &text, qint64 bytesRead);
+  void readFinished(bool ok);
+
+private slots:
+  void handleChunkDecoded(const QString &text, qint64 bytesRead);
+  void handleReadFinished(bool ok);
+  void insertPendingChunks();
+
+private:
+  struct PendingChunk {
+    QString text;
+    qint64 bytesRead = 0;
+  };
+
+  void readFile();
+  void stopWorker();
+  void complete();
+
+  QString path;
+  QPointer<QTextDocument> document;
+  QThread *worker = nullptr;
+  QTimer *insertTimer;
+  QQueue<PendingChunk> pendingChunks;
+  std::atomic_bool cancelRequested{false};
+  std::atomic_int queuedChunks{0};
+  qint64 totalBytes = 0;
+  qint64 insertedBytes = 0;
+  bool readDone = false;
+  bool readOk = false;
+  bool completed = false;
+};
+
+} // namespace Jino::App
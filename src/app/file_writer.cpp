@@ -0,0 +1,78 @@
+#include "app/file_writer.hpp"
+#include "core/constants.hpp"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QTextCodec>
+#include <QThreadPool>
+
+namespace Jino::App {
+
+namespace {
+bool writeAtomically(const QString &path, const QString &text,
+                     QString &error) {
+  QDir dir = QFileInfo(path).dir();
+  if (!dir.exists() && !dir.mkpath(".")) {
+    error = QString("Cannot create directory %1").arg(dir.path());
+    return false;
+  }
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    error = file.errorString();
+    return false;
+  }
+  QTextCodec *codec =
+      QTextCodec::codecForName(Constants::DEFAULT_FILE_ENCODING);
+  const QByteArray bytes = codec->fromUnicode(text);
+  if (file.write(bytes) != bytes.size()) {
+    error = file.errorString();
+    file.cancelWriting();
+    return false;
+  }
+  if (!file.commit()) {
+    error = file.errorString();
+    return false;
+  }
+  return true;
+}
+
+class WriteTask : public QRunnable {
+public:
+  WriteTask(FileWriter *writer, quint64 ticket, const QString &path,
+            const QString &text)
+      : writer(writer), ticket(ticket), path(path), text(text) {}
+
+  void run() override {
+    QString error;
+    const bool ok = writeAtomically(path, text, error);
+    text.clear();
+    emit writer->writeFinished(ticket, path, ok, error);
+  }
+
+private:
+  FileWriter *writer;
+  quint64 ticket;
+  QString path;
+  QString text;
+};
+} // namespace
+
+FileWriter::FileWriter(QObject *parent)
+    : QObject(parent), pool(new QThreadPool(this)) {
+  pool->setMaxThreadCount(1);
+  pool->setExpiryTimeout(-1);
+}
+
+FileWriter::~FileWriter() { pool->waitForDone(); }
+
+quint64 FileWriter::write(const QString &path, const QString &text) {
+  const quint64 ticket = nextTicket++;
+  pool->start(new WriteTask(this, ticket, path, text));
+  return ticket;
+}
+
+void FileWriter::waitForDone() { pool->waitForDone(); }
+
+} // namespace Jino::App
@@ -0,0 +1,35 @@
+// src/app/file_writer.hpp
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+class QThreadPool;
+
+namespace Jino::App {
+
+// Writes text snapshots to disk on a single background thread; the caller
+// hands over a copy of the text and encoding happens on that thread. Each
+// write goes to a temporary file next to the target which is synced and
+// renamed into place, so an interrupted save never leaves a truncated file.
+// Writes are applied in submission order.
+class FileWriter : public QObject {
+  Q_OBJECT
+
+public:
+  explicit FileWriter(QObject *parent = nullptr);
+  ~FileWriter() override;
+
+  quint64 write(const QString &path, const QString &text);
+  void waitForDone();
+
+signals:
+  void writeFinished(quint64 ticket, const QString &path, bool ok,
+                     const QString &error);
+
+private:
+  QThreadPool *pool;
+  quint64 nextTicket = 1;
+};
+
+} // namespace Jino::App
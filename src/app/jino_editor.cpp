@@ -1,7 +1,11 @@
 #include "app/jino_editor.hpp"
+#include "app/autosave_scheduler.hpp"
+#include "app/edit_journal.hpp"
 #include "QtAwesome.h"
 #include "core/constants.hpp"
 #include "editor/editor_widget.hpp"
+#include "editor/format_palette.hpp"
+#include "editor/syntax_theme.hpp"
 #include "editor/vim/vim_handler.hpp"
 #include "editor/vim/vim_modes.hpp"
 
@@ -33,6 +37,7 @@
 #include <QTimer>
 #include <QToolBar>
 #include <QToolButton>
+#include <QUuid>
 #include <chrono>
 #include <random>
 #include <vector>
@@ -49,6 +54,17 @@ QString getRandomAngelNameInternal() {
       0, Constants::ANGEL_NAMES.size() - 1);
   return Constants::ANGEL_NAMES[distribution(generator)];
 }
+
+QString loadStyleSheetFromResource(const QString &themeName) {
+  QString resourcePath = QString(":/themes/%1.qss").arg(themeName);
+  QFile f(resourcePath);
+  if (!f.open(QFile::ReadOnly | QFile::Text)) {
+    qWarning() << "Could not load theme file:" << resourcePath;
+    return QString();
+  }
+  QTextStream ts(&f);
+  return ts.readAll();
+}
 } // namespace
 
 JinoEditor::JinoEditor(QWidget *parent, const QString &workspaceName,
@@ -80,6 +96,15 @@ void JinoEditor::setupInitialUi() {
   resize(Constants::DEFAULT_WINDOW_WIDTH, Constants::DEFAULT_WINDOW_HEIGHT);
   sessionTimer.start();
   elapsedTimerClock = new QTimer(this);
+  uiRefresh = new UiRefreshScheduler(this);
+  connect(uiRefresh, &UiRefreshScheduler::flushRequested, this,
+          &JinoEditor::flushUiStates);
+  fileWriter = new FileWriter(this);
+  connect(fileWriter, &FileWriter::writeFinished, this,
+          &JinoEditor::handleSaveFinished);
+  autosave = new AutosaveScheduler(this);
+  connect(autosave, &AutosaveScheduler::persistRequested, this,
+          &JinoEditor::handleAutosaveRequested);
   loadFont();
   menuManager = new MenuManager(this, awesome);
   menuManager->setupMenusAndActions(menuBar(), tabWidget);
@@ -100,6 +125,8 @@ void JinoEditor::setupInitialUi() {
           &JinoEditor::handleRemoveRecentFileRequested);
   connect(menuManager, &MenuManager::closeBufferRequested, this,
           &JinoEditor::handleCloseBufferRequested);
+  connect(menuManager, &MenuManager::themeRequested, this,
+          &JinoEditor::applyTheme);
 
   connect(statusBarManager, &StatusBarManager::editorModeChangeRequested, this,
           &JinoEditor::handleStatusBarEditorModeChangeRequested);
@@ -125,6 +152,8 @@ void JinoEditor::setupInitialUi() {
           &JinoEditor::handlePasteAndReplaceRequested);
   connect(statusBarManager, &StatusBarManager::clearFileRequested, this,
           &JinoEditor::handleClearFileRequested);
+  connect(statusBarManager, &StatusBarManager::cancelLoadRequested, this,
+          &JinoEditor::handleCancelLoadRequested);
 
   connect(menuManager->newTabAction, &QAction::triggered, this,
           &JinoEditor::onNewTabAction);
@@ -152,8 +181,10 @@ void JinoEditor::setupInitialUi() {
 
   connect(tabWidget, &QTabWidget::currentChanged, this,
           &JinoEditor::handleCurrentTabChanged);
-  connect(QApplication::clipboard(), &QClipboard::dataChanged, this,
-          &JinoEditor::updateUiStates);
+  connect(QApplication::clipboard(), &QClipboard::dataChanged, this, [this]() {
+    markUiDirty(UiRefreshScheduler::TopStatusBar |
+                UiRefreshScheduler::ActionStates);
+  });
   connect(elapsedTimerClock, &QTimer::timeout, this,
           &JinoEditor::updateElapsedTime);
 
@@ -170,6 +201,10 @@ void JinoEditor::loadSettings() {
   QSettings s;
   recentFilesList =
       s.value(Constants::SETTINGS_KEY_RECENT_FILES).toStringList();
+  largeFileThreshold =
+      s.value(Constants::SETTINGS_KEY_LARGE_FILE_THRESHOLD,
+              Constants::DEFAULT_LARGE_FILE_THRESHOLD_BYTES)
+          .toLongLong();
   if (menuManager)
     menuManager->updateRecentMenu(recentFilesList);
 }
@@ -177,6 +212,13 @@ void JinoEditor::saveSettings() {
   QSettings s;
   s.setValue(Constants::SETTINGS_KEY_RECENT_FILES, recentFilesList);
 }
+void JinoEditor::applyTheme(const QString &theme) {
+  qApp->setStyleSheet(loadStyleSheetFromResource(theme));
+  Editor::FormatPalette::instance().setThemeColors(
+      Editor::syntaxColorsForTheme(theme));
+  menuManager->setCurrentTheme(theme);
+  QSettings().setValue(Constants::SETTINGS_KEY_THEME, theme);
+}
 void JinoEditor::loadFont() {
   const int id =
       QFontDatabase::addApplicationFont(Constants::FONT_RESOURCE_PATH);
@@ -196,17 +238,27 @@ void JinoEditor::setupEditorConnections(EditorWidget *editor) {
           &JinoEditor::onSaveAsAction);
   connect(editor->document(), &QTextDocument::modificationChanged, this,
           &JinoEditor::handleModificationChanged);
+  auto markTopStatusBar = [this]() {
+    markUiDirty(UiRefreshScheduler::TopStatusBar);
+  };
+  auto markActionStates = [this]() {
+    markUiDirty(UiRefreshScheduler::ActionStates);
+  };
   connect(editor->document(), &QTextDocument::contentsChanged, this,
-          &JinoEditor::updateUiStates);
-  connect(editor, &QTextEdit::copyAvailable, this, &JinoEditor::updateUiStates);
-  connect(editor, &QTextEdit::undoAvailable, this, &JinoEditor::updateUiStates);
-  connect(editor, &QTextEdit::redoAvailable, this, &JinoEditor::updateUiStates);
-  connect(editor, &QTextEdit::selectionChanged, this,
-          &JinoEditor::updateUiStates);
-  connect(editor, &QTextEdit::cursorPositionChanged, this,
-          &JinoEditor::updateUiStates);
-  connect(editor, &EditorWidget::vimModeChanged, this,
-          &JinoEditor::updateUiStates);
+          markTopStatusBar);
+  connect(editor->document(), &QTextDocument::contentsChanged, this,
+          [this, editor]() {
+            if (!isEditorLoading(editor))
+              autosave->markDirty(editor);
+          });
+  connect(editor, &QPlainTextEdit::copyAvailable, this, markActionStates);
+  connect(editor, &QPlainTextEdit::undoAvailable, this, markActionStates);
+  connect(editor, &QPlainTextEdit::redoAvailable, this, markActionStates);
+  connect(editor, &QPlainTextEdit::selectionChanged, this, markActionStates);
+  connect(editor, &QPlainTextEdit::cursorPositionChanged, this,
+          markTopStatusBar);
+  connect(editor, &EditorWidget::vimModeChanged, this, markTopStatusBar);
+  connect(editor, &EditorWidget::viewLineChanged, this, markTopStatusBar);
   connect(editor->document(), &QTextDocument::modificationChanged, this,
           [this, editor]() {
             int index = tabWidget->indexOf(editor);
@@ -243,21 +295,36 @@ void JinoEditor::setupShortcuts() {
 }
 
 void JinoEditor::updateUiStates() {
+  markUiDirty(UiRefreshScheduler::AllParts);
+}
 
+void JinoEditor::markUiDirty(UiRefreshScheduler::Parts parts) {
+  if (uiRefresh)
+    uiRefresh->markDirty(parts);
+}
+
+void JinoEditor::flushUiStates(UiRefreshScheduler::Parts parts) {
   EditorWidget *editor = currentEditorWidget();
-  bool editorExists = (editor != nullptr);
-  bool hasSelection = editorExists && editor->textCursor().hasSelection();
-  bool undoAvailable = editorExists && editor->document()->isUndoAvailable();
-  bool redoAvailable = editorExists && editor->document()->isRedoAvailable();
-  bool pasteAvailable = QApplication::clipboard()->mimeData()->hasText();
-  if (statusBarManager)
+  if (statusBarManager && parts.testFlag(UiRefreshScheduler::TopStatusBar))
     statusBarManager->updateTopStatusBar(editor);
   if (menuManager) {
-    menuManager->updateActionStates(editorExists, hasSelection, undoAvailable,
-                                    redoAvailable, pasteAvailable);
-    menuManager->updateBuffersMenu(tabWidget->currentIndex());
+    if (parts.testFlag(UiRefreshScheduler::ActionStates)) {
+      bool editorExists = (editor != nullptr);
+      bool hasSelection = editorExists && editor->textCursor().hasSelection();
+      bool undoAvailable =
+          editorExists && editor->document()->isUndoAvailable();
+      bool redoAvailable =
+          editorExists && editor->document()->isRedoAvailable();
+      bool pasteAvailable = QApplication::clipboard()->mimeData()->hasText();
+      menuManager->updateActionStates(editorExists, hasSelection,
+                                      undoAvailable, redoAvailable,
+                                      pasteAvailable);
+    }
+    if (parts.testFlag(UiRefreshScheduler::BuffersMenu))
+      menuManager->updateBuffersMenu(tabWidget->currentIndex());
   }
-  updateWindowTitle();
+  if (parts.testFlag(UiRefreshScheduler::WindowTitle))
+    updateWindowTitle();
 }
 
 void JinoEditor::updateElapsedTime() {
@@ -272,6 +339,7 @@ void JinoEditor::updateElapsedTime() {
                     .arg(s, 2, 10, QChar('0'));
     statusBarManager->updateTimeDisplay(t);
   }
+  updatePersistIndicator();
 }
 void JinoEditor::handleModificationChanged(bool) { updateUiStates(); }
 void JinoEditor::applyEditorFont(EditorWidget *e) {
@@ -384,14 +452,16 @@ void JinoEditor::handleStatusBarEditorModeChangeRequested() {
     return;
   QMenu mm(this);
   mm.setObjectName("EditorModeSelectionMenu");
-  for (const auto &m : Constants::getAllEditorModes()) {
-    QAction *a = mm.addAction(Constants::editorModeToString(m));
+  for (const auto &m : Editor::Syntax::Registry::instance().modes()) {
+    QAction *a = mm.addAction(m.label());
     a->setCheckable(true);
-    a->setChecked(e->editorMode() == m);
+    a->setChecked(e->editorMode() == m.type &&
+                  e->editorGrammar() == m.grammar);
     connect(a, &QAction::triggered, this,
             [this, m]() { this->changeEditorMode(m); });
     if (awesome)
-      a->setIcon(awesome->icon(fa::fa_solid, Jino::App::getIconForFileType(m)));
+      a->setIcon(
+          awesome->icon(fa::fa_solid, Jino::App::getIconForFileType(m.type)));
   }
   QWidget *mw = statusBarManager->getEditorModeWidget();
   if (mw)
@@ -400,9 +470,10 @@ void JinoEditor::handleStatusBarEditorModeChangeRequested() {
     mm.exec(QCursor::pos());
 }
 void JinoEditor::handleStatusBarCloseRequested() { closeCurrentTab(); }
-void JinoEditor::changeEditorMode(Jino::Constants::EditorFileType newMode) {
+void JinoEditor::changeEditorMode(
+    const Jino::Editor::Syntax::FileMode &newMode) {
   if (EditorWidget *e = currentEditorWidget()) {
-    e->setEditorMode(newMode);
+    e->setEditorMode(newMode.type, newMode.grammar);
     updateUiStates();
   }
 }
@@ -412,8 +483,8 @@ void JinoEditor::handleGoToLineRequested() {
   if (!editor)
     return;
   bool ok;
-  int currentLine = editor->textCursor().blockNumber() + 1;
-  int maxLine = editor->document()->blockCount();
+  int currentLine = editor->currentLineIndex() + 1;
+  int maxLine = editor->lineCount();
   int line = QInputDialog::getInt(this, Constants::INPUT_GOTO_LINE_TITLE,
                                   Constants::INPUT_GOTO_LINE_LABEL, currentLine,
                                   1, maxLine, 1, &ok);
@@ -492,15 +563,10 @@ void JinoEditor::handleCurrentTabChanged(int index) {
     connect(currentEditor, &EditorWidget::zoomPercentChanged, statusBarManager,
             &StatusBarManager::updateZoomDisplay);
     currentlyConnectedEditor = currentEditor;
-    if (statusBarManager)
-      statusBarManager->updateTopStatusBar(currentEditor);
-  } else {
-    if (statusBarManager)
-      statusBarManager->updateTopStatusBar(nullptr);
   }
-  updateWindowTitle();
-  if (menuManager)
-    menuManager->updateBuffersMenu(tabWidget->currentIndex());
+  updateLoadProgress();
+  updatePersistIndicator();
+  updateUiStates();
 }
 
 void JinoEditor::newTab() {
@@ -519,6 +585,7 @@ void JinoEditor::newTab() {
   tabWidget->setCurrentIndex(newTabIndex);
   setCurrentFile(editor, QString());
   setupEditorConnections(editor);
+  attachJournal(editor, false);
   updateUiStates();
   initialTabCreated = true;
 }
@@ -569,8 +636,7 @@ void JinoEditor::openSingleFile(const QString &filePath) {
         3000);
     return;
   }
-  QString content;
-  if (loadFileContent(filePath, content)) {
+  if (canOpenFile(filePath)) {
     EditorWidget *etu;
     if (reuse) {
       etu = ce;
@@ -582,13 +648,19 @@ void JinoEditor::openSingleFile(const QString &filePath) {
         return;
       qInfo() << "Created new tab for:" << filePath;
     }
-    etu->setPlainText(content);
     applyEditorFont(etu);
     setCurrentFile(etu, filePath);
     addRecentFile(filePath);
-    statusBar()->showMessage(
-        Constants::STATUS_FILE_OPENED.arg(QFileInfo(filePath).fileName()),
-        3000);
+    const QFileInfo info(filePath);
+    if (largeFileThreshold > 0 && info.size() >= largeFileThreshold &&
+        etu->openLargeFile(filePath)) {
+      discardJournal(etu);
+      qInfo() << "Opened in large file view:" << filePath << info.size();
+      statusBar()->showMessage(
+          Constants::STATUS_FILE_READ_ONLY_VIEW.arg(info.fileName()), 3000);
+    } else {
+      startFileLoad(etu, filePath);
+    }
     updateUiStates();
   } else {
     recentFilesList.removeAll(filePath);
@@ -597,7 +669,7 @@ void JinoEditor::openSingleFile(const QString &filePath) {
   }
 }
 
-bool JinoEditor::loadFileContent(const QString &path, QString &content) {
+bool JinoEditor::canOpenFile(const QString &path) {
   QFile file(path);
   if (!file.open(QIODevice::ReadOnly)) {
     QMessageBox::warning(
@@ -607,58 +679,215 @@ bool JinoEditor::loadFileContent(const QString &path, QString &content) {
                              5000);
     return false;
   }
-  QTextStream in(&file);
-  in.setCodec(Constants::DEFAULT_FILE_ENCODING.constData());
-  QApplication::setOverrideCursor(Qt::WaitCursor);
-  content = in.readAll();
-  QApplication::restoreOverrideCursor();
   file.close();
   return true;
 }
+void JinoEditor::startFileLoad(EditorWidget *editor, const QString &path) {
+  if (!editor)
+    return;
+  cancelFileLoad(editor);
+  discardJournal(editor);
+  editor->setLoadIncomplete(false);
+  editor->clear();
+  editor->setLoading(true);
+  auto loader = new FileLoader(path, editor->document(), this);
+  fileLoaders[editor] = loader;
+  QPointer<EditorWidget> target = editor;
+  connect(loader, &FileLoader::progressChanged, this, [this, target]() {
+    if (target && target == currentEditorWidget())
+      updateLoadProgress();
+  });
+  connect(loader, &FileLoader::finished, this, [this, target](bool ok) {
+    if (target)
+      finishFileLoad(target, ok);
+  });
+  loader->start();
+  updateLoadProgress();
+}
+void JinoEditor::finishFileLoad(EditorWidget *editor, bool ok) {
+  QPointer<FileLoader> loader = fileLoaders.take(editor);
+  const QString path = loader ? loader->filePath() : getCurrentFile(editor);
+  if (loader)
+    loader->deleteLater();
+  // A partly read buffer is locked and kept out of autosave and the
+  // journal; saving it would cut the file down to what was read.
+  editor->setLoadIncomplete(!ok);
+  editor->setLoading(false);
+  editor->document()->setModified(false);
+  if (ok) {
+    attachJournal(editor, true);
+    autosave->markPersisted(editor, true);
+    statusBar()->showMessage(
+        Constants::STATUS_FILE_OPENED.arg(QFileInfo(path).fileName()), 3000);
+  } else {
+    qWarning() << "Failed while reading:" << path;
+    autosave->forget(editor);
+    statusBar()->showMessage(Constants::STATUS_FILE_LOAD_INCOMPLETE.arg(path),
+                             5000);
+  }
+  updateLoadProgress();
+  updateUiStates();
+}
+void JinoEditor::cancelFileLoad(EditorWidget *editor) {
+  QPointer<FileLoader> loader = fileLoaders.take(editor);
+  if (!loader)
+    return;
+  loader->cancel();
+  delete loader;
+  editor->setLoading(false);
+  editor->document()->setModified(false);
+  updateLoadProgress();
+}
+bool JinoEditor::isEditorLoading(EditorWidget *editor) const {
+  return editor && fileLoaders.value(editor);
+}
+void JinoEditor::updateLoadProgress() {
+  if (!statusBarManager)
+    return;
+  EditorWidget *e = currentEditorWidget();
+  FileLoader *loader = e ? fileLoaders.value(e).data() : nullptr;
+  if (loader)
+    statusBarManager->showLoadProgress(
+        QFileInfo(loader->filePath()).fileName(), loader->progressPercent());
+  else
+    statusBarManager->hideLoadProgress();
+}
+void JinoEditor::handleCancelLoadRequested() {
+  EditorWidget *e = currentEditorWidget();
+  if (!isEditorLoading(e))
+    return;
+  const QString name = QFileInfo(getCurrentFile(e)).fileName();
+  cancelFileLoad(e);
+  maybeCloseTab(tabWidget->currentIndex());
+  statusBar()->showMessage(Constants::STATUS_FILE_LOAD_CANCELED.arg(name),
+                           3000);
+}
 bool JinoEditor::saveFileLogic(const QString &p) {
   EditorWidget *e = currentEditorWidget();
   if (!e || p.isEmpty())
     return false;
-  QFileInfo fi(p);
-  QDir d = fi.dir();
-  if (!d.exists() && !d.mkpath("."))
+  if (isEditorLoading(e)) {
+    statusBar()->showMessage(
+        Constants::STATUS_FILE_STILL_LOADING.arg(QFileInfo(p).fileName()),
+        3000);
     return false;
-  QFile f(p);
-  if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-    QMessageBox::warning(this, Constants::APP_NAME,
-                         Constants::STATUS_FILE_SAVE_FAILED.arg(fi.fileName()));
-    statusBar()->showMessage(Constants::STATUS_FILE_SAVE_FAILED.arg(p), 5000);
+  }
+  if (e->isLargeFileView()) {
+    statusBar()->showMessage(
+        Constants::STATUS_FILE_READ_ONLY_VIEW.arg(QFileInfo(p).fileName()),
+        3000);
     return false;
   }
-  QTextStream o(&f);
-  o.setCodec(Constants::DEFAULT_FILE_ENCODING.constData());
-  QApplication::setOverrideCursor(Qt::WaitCursor);
-  o << e->toPlainText();
-  QApplication::restoreOverrideCursor();
-  o.flush();
-  f.close();
-  if (f.error() != QFile::NoError)
+  if (e->isLoadIncomplete()) {
+    statusBar()->showMessage(
+        Constants::STATUS_FILE_LOAD_INCOMPLETE.arg(QFileInfo(p).fileName()),
+        3000);
     return false;
-  setCurrentFile(e, p);
-  addRecentFile(p);
+  }
+  submitSave(e, p, ExplicitSave);
+  statusBar()->showMessage(
+      Constants::STATUS_FILE_SAVING.arg(QFileInfo(p).fileName()));
   return true;
 }
+void JinoEditor::submitSave(EditorWidget *editor, const QString &path,
+                            SaveKind kind) {
+  PendingSave pending;
+  pending.editor = editor;
+  pending.revision = editor->document()->revision();
+  pending.kind = kind;
+  if (kind == CloseAutosave) {
+    QPointer<EditJournal> journal = editorJournals.take(editor);
+    if (journal) {
+      journal->flush();
+      pending.journalPath = journal->journalPath();
+    }
+  }
+  pendingSaves.insert(
+      fileWriter->write(path, editor->document()->toPlainText()), pending);
+}
+void JinoEditor::handleSaveFinished(quint64 ticket, const QString &path,
+                                    bool ok, const QString &error) {
+  const PendingSave pending = pendingSaves.take(ticket);
+  const QString name = QFileInfo(path).fileName();
+  if (ok && !pending.journalPath.isEmpty())
+    QFile::remove(pending.journalPath);
+  if (!ok) {
+    qWarning() << "Save failed:" << path << error;
+    if (pending.kind != ExplicitSave) {
+      statusBar()->showMessage(QString("Autosave failed: %1").arg(name), 5000);
+      if (pending.editor)
+        autosave->markPersistFailed(pending.editor);
+    } else {
+      QMessageBox::warning(this, Constants::APP_NAME,
+                           Constants::STATUS_FILE_SAVE_FAILED.arg(name));
+      statusBar()->showMessage(Constants::STATUS_FILE_SAVE_FAILED.arg(path),
+                               5000);
+    }
+    return;
+  }
+  EditorWidget *e = pending.editor;
+  if (!e || tabWidget->indexOf(e) == -1)
+    return;
+  const bool current = e->document()->revision() == pending.revision;
+  autosave->markPersisted(e, current);
+  updatePersistIndicator();
+  if (pending.kind != ExplicitSave) {
+    QWidget *ep = e;
+    editorFilePaths[ep] = path;
+    if (current)
+      e->document()->setModified(false);
+    if (pending.kind == IdleAutosave)
+      attachJournal(e, current);
+    if (e == currentEditorWidget()) {
+      int idx = tabWidget->currentIndex();
+      updateTabTitle(idx);
+      updateTabToolTip(idx);
+      updateWindowTitle();
+    }
+    return;
+  }
+  setCurrentFile(e, path);
+  if (!current)
+    e->document()->setModified(true);
+  attachJournal(e, current);
+  addRecentFile(path);
+  statusBar()->showMessage(Constants::STATUS_FILE_SAVED.arg(name), 3000);
+}
+void JinoEditor::handleAutosaveRequested(QWidget *buffer) {
+  EditorWidget *e = qobject_cast<EditorWidget *>(buffer);
+  if (!e || tabWidget->indexOf(e) == -1 || isEditorLoading(e) ||
+      e->isLargeFileView() || e->isLoadIncomplete()) {
+    autosave->forget(buffer);
+    return;
+  }
+  if (!e->document()->isModified()) {
+    autosave->markPersisted(e, true);
+    return;
+  }
+  autoSaveBuffer(e, IdleAutosave);
+}
+void JinoEditor::updatePersistIndicator() {
+  if (!statusBarManager || !autosave)
+    return;
+  EditorWidget *e = currentEditorWidget();
+  if (!e || e->isLargeFileView()) {
+    statusBarManager->updatePersistDisplay(-1, false, false);
+    return;
+  }
+  statusBarManager->updatePersistDisplay(autosave->msecsSincePersist(e),
+                                         e->document()->isModified(), true);
+}
 bool JinoEditor::saveFile() {
   EditorWidget *e = currentEditorWidget();
   if (!e)
     return false;
   QString cp = getCurrentFile(e);
   if (cp.isEmpty() ||
-      (cp.startsWith("." + currentWorkspaceName + "_") &&
+      (QFileInfo(cp).fileName().startsWith("." + currentWorkspaceName + "_") &&
        QFileInfo(cp).dir().path() == Constants::DEFAULT_NOTES_DIR)) {
     return saveFileAs();
   } else {
-    if (saveFileLogic(cp)) {
-      statusBar()->showMessage(
-          Constants::STATUS_FILE_SAVED.arg(QFileInfo(cp).fileName()), 3000);
-      return true;
-    }
-    return false;
+    return saveFileLogic(cp);
   }
 }
 bool JinoEditor::saveFileAs() {
@@ -684,15 +913,14 @@ bool JinoEditor::saveFileAs() {
   const QString p = QFileDialog::getSaveFileName(this, "Save File As", ip);
   if (p.isEmpty())
     return false;
-  if (saveFileLogic(p)) {
-    statusBar()->showMessage(
-        Constants::STATUS_FILE_SAVED.arg(QFileInfo(p).fileName()), 3000);
-    return true;
-  }
-  return false;
+  return saveFileLogic(p);
 }
 bool JinoEditor::autoSaveBufferOnClose(EditorWidget *editor) {
-  if (!editor || !editor->document() || !editor->document()->isModified())
+  return autoSaveBuffer(editor, CloseAutosave);
+}
+bool JinoEditor::autoSaveBuffer(EditorWidget *editor, SaveKind kind) {
+  if (!editor || !editor->document() || !editor->document()->isModified() ||
+      editor->isLoadIncomplete())
     return false;
   QString cp = getCurrentFile(editor);
   QString sp;
@@ -710,38 +938,8 @@ bool JinoEditor::autoSaveBufferOnClose(EditorWidget *editor) {
     sp = cp;
     qInfo() << "Autosaving:" << sp;
   }
-  auto iS = [&](const QString &p, const QString &c) -> bool {
-    QFileInfo fi(p);
-    QDir d = fi.dir();
-    if (!d.exists() && !d.mkpath("."))
-      return false;
-    QFile f(p);
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
-      return false;
-    QTextStream o(&f);
-    o.setCodec(Constants::DEFAULT_FILE_ENCODING.constData());
-    o << c;
-    o.flush();
-    f.close();
-    return f.error() == QFile::NoError;
-  };
-  if (iS(sp, editor->toPlainText())) {
-    QWidget *ep = editor;
-    editorFilePaths[ep] = sp;
-    editor->document()->setModified(false);
-    if (editor == currentEditorWidget()) {
-      int idx = tabWidget->currentIndex();
-      updateTabTitle(idx);
-      updateTabToolTip(idx);
-      updateWindowTitle();
-    }
-    return true;
-  } else {
-    qWarning() << "Autosave failed:" << sp;
-    statusBar()->showMessage(
-        QString("Autosave failed: %1").arg(QFileInfo(sp).fileName()), 5000);
-    return false;
-  }
+  submitSave(editor, sp, kind);
+  return true;
 }
 
 void JinoEditor::closeCurrentTab() {
@@ -756,7 +954,9 @@ void JinoEditor::maybeCloseTab(int index) {
   QWidget *w = tabWidget->widget(index);
   if (!e || !w)
     return;
-  if (e->document()->isModified())
+  if (isEditorLoading(e))
+    cancelFileLoad(e);
+  else if (e->document()->isModified())
     autoSaveBufferOnClose(e);
   EditorWidget *ce = editorWidgetForIndex(index);
   cleanupEditorData(w);
@@ -776,16 +976,92 @@ void JinoEditor::maybeCloseTab(int index) {
   updateUiStates();
 }
 void JinoEditor::closeEvent(QCloseEvent *event) {
-  for (int i = tabWidget->count() - 1; i >= 0; --i)
-    autoSaveBufferOnClose(editorWidgetForIndex(i));
+  for (int i = tabWidget->count() - 1; i >= 0; --i) {
+    EditorWidget *e = editorWidgetForIndex(i);
+    if (isEditorLoading(e))
+      cancelFileLoad(e);
+    else
+      autoSaveBufferOnClose(e);
+    discardJournal(e);
+  }
   saveSettings();
+  if (fileWriter) {
+    fileWriter->waitForDone();
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+  }
+  if (uiRefresh)
+    qInfo() << "UI refreshes:" << uiRefresh->flushCount() << "flushed for"
+            << uiRefresh->requestCount() << "requests,"
+            << uiRefresh->savedFlushCount() << "saved";
   event->accept();
 }
 void JinoEditor::cleanupEditorData(QWidget *editorWidget) {
   if (!editorWidget)
     return;
+  discardJournal(editorWidget);
+  if (autosave)
+    autosave->forget(editorWidget);
   editorFilePaths.remove(editorWidget);
   editorBaseNames.remove(editorWidget);
+  fileLoaders.remove(editorWidget);
+}
+
+void JinoEditor::attachJournal(EditorWidget *editor, bool matchesFile) {
+  if (!editor || editor->isLargeFileView())
+    return;
+  QPointer<EditJournal> &journal = editorJournals[editor];
+  if (!journal) {
+    const QString path =
+        QString("%1/.%2_%3%4")
+            .arg(Constants::DEFAULT_NOTES_DIR, currentWorkspaceName,
+                 QUuid::createUuid().toString(QUuid::Id128),
+                 Constants::JOURNAL_FILE_SUFFIX);
+    journal = new EditJournal(editor->document(), path, editor);
+  }
+  const QString filePath = getCurrentFile(editor);
+  const QString baseName = getBaseNameForEditor(editor);
+  if (matchesFile && !filePath.isEmpty())
+    journal->resetToFile(filePath, baseName);
+  else
+    journal->resetToSnapshot(filePath, baseName);
+}
+void JinoEditor::discardJournal(QWidget *editorWidget) {
+  QPointer<EditJournal> journal = editorJournals.take(editorWidget);
+  if (!journal)
+    return;
+  journal->discard();
+  journal->deleteLater();
+}
+void JinoEditor::recoverJournals() {
+  int recovered = 0;
+  const QStringList journals =
+      EditJournal::findOrphans(Constants::DEFAULT_NOTES_DIR);
+  for (const QString &journal : journals) {
+    EditJournal::Recovery recovery;
+    if (!EditJournal::recover(journal, recovery)) {
+      qWarning() << "Could not recover journal:" << journal;
+      QFile::rename(journal, journal + ".failed");
+      continue;
+    }
+    if (tabWidget->count() >= Constants::MAX_TABS_PER_WORKSPACE)
+      break;
+    newTab();
+    EditorWidget *editor = currentEditorWidget();
+    if (!editor)
+      break;
+    if (!recovery.baseName.isEmpty())
+      setBaseNameForEditor(editor, recovery.baseName);
+    setCurrentFile(editor, recovery.filePath);
+    editor->setPlainText(recovery.text);
+    attachJournal(editor, false);
+    editor->document()->setModified(true);
+    QFile::remove(journal);
+    qInfo() << "Recovered buffer from journal:" << journal;
+    ++recovered;
+  }
+  if (recovered > 0)
+    statusBar()->showMessage(Constants::STATUS_BUFFERS_RECOVERED.arg(recovered),
+                             5000);
 }
 
 EditorWidget *JinoEditor::currentEditorWidget() const {
@@ -819,13 +1095,9 @@ void JinoEditor::setCurrentFile(EditorWidget *e, const QString &p) {
       setBaseNameForEditor(e, getRandomAngelName());
   }
   e->document()->setModified(false);
-  QString ext = QFileInfo(p).suffix().toLower();
-  if (ext == "org")
-    e->setEditorMode(Constants::EditorFileType::Org);
-  else if (ext == "md")
-    e->setEditorMode(Constants::EditorFileType::Markdown);
-  else
-    e->setEditorMode(Constants::EditorFileType::Text);
+  const Editor::Syntax::FileMode mode =
+      Editor::Syntax::Registry::instance().modeForPath(p);
+  e->setEditorMode(mode.type, mode.grammar);
   const int ti = tabWidget->indexOf(ew);
   if (ti != -1) {
     updateTabTitle(ti);
@@ -951,12 +1223,8 @@ QString JinoEditor::formatFileInfoToolTip(const QString &filePath) const {
   pss += (ps & QFile::ReadOther) ? "r" : "-";
   pss += (ps & QFile::WriteOther) ? "w" : "-";
   pss += (ps & QFile::ExeOther) ? "x" : "-";
-  QString ext = fi.suffix().toLower();
-  QString typeStr = "Text";
-  if (ext == "org")
-    typeStr = "Org";
-  else if (ext == "md")
-    typeStr = "Markdown";
+  const QString typeStr =
+      Editor::Syntax::Registry::instance().modeForPath(filePath).label();
   return Constants::TOOLTIP_FILE_INFO_FMT.arg(filePath).arg(ss).arg(pss).arg(
       typeStr);
 }
@@ -3,9 +3,13 @@
 
 class EditorWidget;
 
+#include "app/file_loader.hpp"
+#include "app/file_writer.hpp"
 #include "app/menu_manager.hpp"
 #include "app/status_bar_manager.hpp"
+#include "app/ui_refresh_scheduler.hpp"
 #include "core/constants.hpp"
+#include "editor/syntax/syntax_registry.hpp"
 #include "editor/vim/vim_modes.hpp"
 
 #include <QElapsedTimer>
@@ -30,6 +34,8 @@ class QtAwesome;
 
 namespace Jino::App {
 
+class AutosaveScheduler;
+class EditJournal;
 class StatusBarManager;
 class MenuManager;
 
@@ -43,9 +49,13 @@ public:
   ~JinoEditor() override;
 
   void openFilesFromCli(const QStringList &filePaths);
+  void recoverJournals();
   QString getCurrentFile(EditorWidget *e) const;
   QString getBaseNameForEditor(EditorWidget *editor) const;
   QString formatFileInfoToolTip(const QString &filePath) const;
+  // Sets the interface stylesheet and the highlighting colours of `theme`
+  // and remembers it for the next start.
+  void applyTheme(const QString &theme);
 
 protected:
   void closeEvent(QCloseEvent *event) override;
@@ -84,7 +94,7 @@ private slots:
 
   void handleStatusBarEditorModeChangeRequested();
   void handleStatusBarCloseRequested();
-  void changeEditorMode(Jino::Constants::EditorFileType newMode);
+  void changeEditorMode(const Jino::Editor::Syntax::FileMode &newMode);
   void handleGoToLineRequested();
   void handleGoToColumnRequested();
   void handleSaveRequested();
@@ -98,6 +108,10 @@ private slots:
   void handleCloseBufferRequested(int index);
 
   void handleEditorZoomChanged(int percent);
+  void handleCancelLoadRequested();
+  void handleSaveFinished(quint64 ticket, const QString &path, bool ok,
+                          const QString &error);
+  void handleAutosaveRequested(QWidget *buffer);
 
   void redoEdit();
   void undoEdit();
@@ -111,16 +125,35 @@ private slots:
   void handleCurrentTabChanged(int index);
 
 private:
+  enum SaveKind { ExplicitSave, IdleAutosave, CloseAutosave };
+
+  struct PendingSave {
+    QPointer<EditorWidget> editor;
+    int revision = 0;
+    SaveKind kind = ExplicitSave;
+    QString journalPath;
+  };
+
   void loadFont();
   void loadSettings();
   void saveSettings();
   void setupEditorConnections(EditorWidget *editor);
+  void markUiDirty(UiRefreshScheduler::Parts parts);
+  void flushUiStates(UiRefreshScheduler::Parts parts);
   void disconnectEditorSignals(EditorWidget *editor);
   void setupInitialUi();
   void setupShortcuts();
-  bool loadFileContent(const QString &path, QString &content);
+  bool canOpenFile(const QString &path);
+  void startFileLoad(EditorWidget *editor, const QString &path);
+  void finishFileLoad(EditorWidget *editor, bool ok);
+  void cancelFileLoad(EditorWidget *editor);
+  bool isEditorLoading(EditorWidget *editor) const;
+  void updateLoadProgress();
   bool saveFileLogic(const QString &path);
+  void submitSave(EditorWidget *editor, const QString &path, SaveKind kind);
   bool autoSaveBufferOnClose(EditorWidget *editor);
+  bool autoSaveBuffer(EditorWidget *editor, SaveKind kind);
+  void updatePersistIndicator();
   void openSingleFile(const QString &filePath);
   EditorWidget *currentEditorWidget() const;
   EditorWidget *editorWidgetForIndex(int index) const;
@@ -131,6 +164,8 @@ private:
   void setBaseNameForEditor(EditorWidget *editor, const QString &name);
   void addRecentFile(const QString &filePath);
   void cleanupEditorData(QWidget *editorWidget);
+  void attachJournal(EditorWidget *editor, bool matchesFile);
+  void discardJournal(QWidget *editorWidget);
   void updateTabToolTip(int index);
 
   QTabWidget *tabWidget = nullptr;
@@ -139,13 +174,20 @@ private:
 
   StatusBarManager *statusBarManager = nullptr;
   MenuManager *menuManager = nullptr;
+  UiRefreshScheduler *uiRefresh = nullptr;
+  FileWriter *fileWriter = nullptr;
+  AutosaveScheduler *autosave = nullptr;
   fa::QtAwesome *awesome = nullptr;
 
   QMap<QWidget *, QString> editorFilePaths;
   QMap<QWidget *, QString> editorBaseNames;
+  QMap<QWidget *, QPointer<FileLoader>> fileLoaders;
+  QMap<quint64, PendingSave> pendingSaves;
+  QMap<QWidget *, QPointer<EditJournal>> editorJournals;
   QString currentWorkspaceName;
   QStringList recentFilesList;
   bool initialTabCreated = false;
+  qint64 largeFileThreshold = Constants::DEFAULT_LARGE_FILE_THRESHOLD_BYTES;
   QPointer<EditorWidget> currentlyConnectedEditor;
 };
 
@@ -3,6 +3,7 @@
 #include "core/constants.hpp"
 
 #include <QAction>
+#include <QActionGroup>
 #include <QApplication>
 #include <QDebug>
 #include <QFileInfo>
@@ -109,6 +110,7 @@ void MenuManager::setupMenusAndActions(QMenuBar *menuBar,
   QIcon buffersIcon = awesome ? awesome->icon(fa_solid, fa_list_ul) : QIcon();
   QIcon recentIcon =
       awesome ? awesome->icon(fa_solid, fa_clock_rotate_left) : QIcon();
+  QIcon themeIcon = awesome ? awesome->icon(fa_solid, fa_palette) : QIcon();
 
   fileMenu = menuBar->addMenu(fileIcon, "&File");
   fileMenu->addAction(newTabAction);
@@ -134,11 +136,41 @@ void MenuManager::setupMenusAndActions(QMenuBar *menuBar,
   recentMenu = menuBar->addMenu(recentIcon, "&Recent");
   connect(clearRecentAction, &QAction::triggered, this,
           &MenuManager::handleClearRecentTriggered);
+
+  themeMenu = menuBar->addMenu(themeIcon, "&Theme");
+  QActionGroup *themeGroup = new QActionGroup(themeMenu);
+  const QVector<QPair<QString, QString>> themes = {
+      {Jino::Constants::THEME_EVERFOREST, "Everforest"},
+      {Jino::Constants::THEME_TOKYO_NIGHT, "Tokyo Night"},
+      {Jino::Constants::THEME_NIGHT_OWL, "Night Owl"}};
+  for (const auto &theme : themes) {
+    QAction *action = themeMenu->addAction(theme.second);
+    action->setCheckable(true);
+    action->setData(theme.first);
+    themeGroup->addAction(action);
+  }
+  connect(themeGroup, &QActionGroup::triggered, this,
+          [this](QAction *action) {
+            emit themeRequested(action->data().toString());
+          });
+}
+
+void MenuManager::setCurrentTheme(const QString &theme) {
+  if (!themeMenu)
+    return;
+  for (QAction *action : themeMenu->actions())
+    action->setChecked(action->data().toString() == theme);
 }
 
 void MenuManager::updateActionStates(bool editorAvailable, bool hasSelection,
                                      bool undoAvailable, bool redoAvailable,
                                      bool pasteAvailable) {
+  const QVector<bool> inputs = {
+      editorAvailable, hasSelection, undoAvailable, redoAvailable,
+      pasteAvailable, mainTabWidget && mainTabWidget->count() > 0};
+  if (inputs == lastActionInputs)
+    return;
+  lastActionInputs = inputs;
 
   bool modified = editorAvailable && undoAvailable;
   saveAction->setEnabled(modified);
@@ -249,6 +281,16 @@ void MenuManager::updateRecentMenu(const QStringList &recentFiles) {
 void MenuManager::updateBuffersMenu(int currentTab) {
   if (!buffersMenu || !mainTabWidget)
     return;
+  QStringList titles;
+  titles.reserve(mainTabWidget->count());
+  for (int i = 0; i < mainTabWidget->count(); ++i)
+    titles.append(mainTabWidget->tabText(i));
+  if (hasBufferInputs && currentTab == lastBufferIndex &&
+      titles == lastBufferTitles)
+    return;
+  lastBufferTitles = titles;
+  lastBufferIndex = currentTab;
+  hasBufferInputs = true;
   buffersMenu->clear();
 
   if (mainTabWidget->count() == 0) {
@@ -5,6 +5,7 @@
 #include <QObject>
 #include <QStringList>
 #include <QVariant>
+#include <QVector>
 
 class QMainWindow;
 class QMenuBar;
@@ -51,6 +52,7 @@ public:
 public slots:
   void updateRecentMenu(const QStringList &recentFiles);
   void updateBuffersMenu(int currentTab = -1);
+  void setCurrentTheme(const QString &theme);
   void updateActionStates(bool editorAvailable, bool hasSelection,
                           bool undoAvailable, bool redoAvailable,
                           bool pasteAvailable);
@@ -63,6 +65,7 @@ signals:
   void showRecentMenuRequested();
   void removeRecentFileRequested(const QString &filePath);
   void closeBufferRequested(int index);
+  void themeRequested(const QString &theme);
 
 private slots:
   void handleClearRecentTriggered();
@@ -84,6 +87,12 @@ private:
   QMenu *editMenu = nullptr;
   QMenu *buffersMenu = nullptr;
   QMenu *recentMenu = nullptr;
+  QMenu *themeMenu = nullptr;
+
+  QVector<bool> lastActionInputs;
+  QStringList lastBufferTitles;
+  int lastBufferIndex = -1;
+  bool hasBufferInputs = false;
 };
 
 } // namespace Jino::App
@@ -0,0 +1,98 @@
+#include "app/single_instance.hpp"
+#include "core/constants.hpp"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+namespace Jino::App {
+
+namespace {
+constexpr int CONNECT_TIMEOUT_MS = 200;
+constexpr int WRITE_TIMEOUT_MS = 1000;
+} // namespace
+
+SingleInstance::SingleInstance(QObject *parent)
+    : QObject(parent), server(new QLocalServer(this)) {
+  server->setSocketOptions(QLocalServer::UserAccessOption);
+  connect(server, &QLocalServer::newConnection, this,
+          &SingleInstance::handleNewConnection);
+}
+
+QString SingleInstance::serverName() {
+  QString user = qEnvironmentVariable("USER");
+  if (user.isEmpty())
+    user = qEnvironmentVariable("USERNAME");
+  return Constants::APP_APPLICATION_NAME + "-" + user;
+}
+
+bool SingleInstance::sendToRunningInstance(const QStringList &filePaths) {
+  QLocalSocket socket;
+  socket.connectToServer(serverName());
+  if (!socket.waitForConnected(CONNECT_TIMEOUT_MS))
+    return false;
+  QStringList absolutePaths;
+  for (const QString &path : filePaths)
+    absolutePaths << QFileInfo(path).absoluteFilePath();
+  QDataStream out(&socket);
+  out.setVersion(QDataStream::Qt_5_0);
+  out << absolutePaths;
+  if (!socket.waitForBytesWritten(WRITE_TIMEOUT_MS))
+    return false;
+  socket.disconnectFromServer();
+  return true;
+}
+
+bool SingleInstance::listen() {
+  if (server->listen(serverName()))
+    return true;
+  if (server->serverError() == QAbstractSocket::AddressInUseError &&
+      isStaleSocket()) {
+    // A previous instance died without removing its socket.
+    QLocalServer::removeServer(serverName());
+    if (server->listen(serverName()))
+      return true;
+  }
+  qWarning() << "Single instance server failed:" << server->errorString();
+  return false;
+}
+
+// Only a socket nobody answers on may be removed. An instance that is busy
+// and missed the first probe still accepts the connection, or at least
+// does not refuse it, and keeps its socket.
+bool SingleInstance::isStaleSocket() {
+  QLocalSocket socket;
+  socket.connectToServer(serverName());
+  if (socket.waitForConnected(CONNECT_TIMEOUT_MS)) {
+    socket.disconnectFromServer();
+    return false;
+  }
+  return socket.error() == QLocalSocket::ServerNotFoundError ||
+         socket.error() == QLocalSocket::ConnectionRefusedError;
+}
+
+void SingleInstance::handleNewConnection() {
+  while (QLocalSocket *socket = server->nextPendingConnection()) {
+    connect(socket, &QLocalSocket::readyRead, this,
+            [this, socket]() { readFiles(socket); });
+    connect(socket, &QLocalSocket::disconnected, socket,
+            &QObject::deleteLater);
+    if (socket->bytesAvailable() > 0)
+      readFiles(socket);
+  }
+}
+
+void SingleInstance::readFiles(QLocalSocket *socket) {
+  QDataStream in(socket);
+  in.setVersion(QDataStream::Qt_5_0);
+  in.startTransaction();
+  QStringList filePaths;
+  in >> filePaths;
+  if (!in.commitTransaction())
+    return;
+  emit filesReceived(filePaths);
+}
+
+} // namespace Jino::App
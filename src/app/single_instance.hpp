@@ -0,0 +1,39 @@
+// src/app/single_instance.hpp
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QLocalServer;
+class QLocalSocket;
+
+namespace Jino::App {
+
+// Lets later invocations hand their files to an already running process
+// over a per-user local socket instead of starting a second editor.
+class SingleInstance : public QObject {
+  Q_OBJECT
+
+public:
+  explicit SingleInstance(QObject *parent = nullptr);
+
+  static QString serverName();
+  static bool sendToRunningInstance(const QStringList &filePaths);
+
+  bool listen();
+
+signals:
+  void filesReceived(const QStringList &filePaths);
+
+private slots:
+  void handleNewConnection();
+
+private:
+  static bool isStaleSocket();
+  void readFiles(QLocalSocket *socket);
+
+  QLocalServer *server;
+};
+
+} // namespace Jino::App
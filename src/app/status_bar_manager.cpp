@@ -1,6 +1,7 @@
 #include "app/status_bar_manager.hpp"
 #include "QtAwesome.h"
 #include "core/constants.hpp"
+#include "editor/document_stats.hpp"
 #include "editor/editor_widget.hpp"
 #include "editor/vim/vim_modes.hpp"
 
@@ -12,6 +13,7 @@
 #include <QIcon>
 #include <QLabel>
 #include <QMainWindow>
+#include <QProgressBar>
 #include <QSizePolicy>
 #include <QStatusBar>
 #include <QStyle>
@@ -45,6 +47,10 @@ fa::icon_enum getIconForFileType(Jino::Constants::EditorFileType type) {
     return (fa::icon_enum)fa_star_of_life;
   case EditorFileType::Markdown:
     return (fa::icon_enum)fa_markdown;
+  case EditorFileType::Code:
+    return (fa::icon_enum)fa_code;
+  case EditorFileType::LargeFile:
+    return (fa::icon_enum)fa_database;
   case EditorFileType::Text:
   default:
     return (fa::icon_enum)fa_file_lines;
@@ -279,6 +285,35 @@ void StatusBarManager::createTopStatusBar() {
 }
 
 void StatusBarManager::setupMainStatusBar() {
+  loadProgressBar = new QProgressBar(mainWindow);
+  loadProgressBar->setObjectName("MainStatusBarLoadProgress");
+  loadProgressBar->setRange(0, 100);
+  loadProgressBar->setMaximumWidth(160);
+  loadProgressBar->setMaximumHeight(14);
+  loadProgressBar->setTextVisible(false);
+  loadProgressBar->hide();
+  mainWindow->statusBar()->addPermanentWidget(loadProgressBar);
+
+  cancelLoadButton = new QToolButton(mainWindow);
+  cancelLoadButton->setObjectName("MainStatusBarCancelLoadButton");
+  cancelLoadButton->setFocusPolicy(Qt::NoFocus);
+  cancelLoadButton->setStyleSheet("QToolButton { border: none; padding: 1px; "
+                                  "background-color: transparent; }");
+  cancelLoadButton->setToolTip("Cancel Loading");
+  cancelLoadButton->setCursor(Qt::PointingHandCursor);
+  if (awesome)
+    cancelLoadButton->setIcon(awesome->icon(fa::fa_solid, fa::fa_xmark));
+  else
+    cancelLoadButton->setText("x");
+  cancelLoadButton->hide();
+  connect(cancelLoadButton, &QToolButton::clicked, this,
+          &StatusBarManager::cancelLoadRequested);
+  mainWindow->statusBar()->addPermanentWidget(cancelLoadButton);
+
+  persistLabel = new QLabel(mainWindow);
+  persistLabel->setObjectName("MainStatusBarPersistLabel");
+  mainWindow->statusBar()->addPermanentWidget(persistLabel);
+
   statusBarWorkspaceLabel = new QLabel(mainWindow);
   statusBarWorkspaceLabel->setObjectName("MainStatusBarWorkspaceLabel");
   QString dName = currentWorkspaceName;
@@ -296,11 +331,51 @@ void StatusBarManager::setupMainStatusBar() {
   mainWindow->statusBar()->addPermanentWidget(statusBarWorkspaceLabel);
 }
 
+bool StatusBarManager::TopStatusInputs::operator==(
+    const TopStatusInputs &other) const {
+  return editor == other.editor && modified == other.modified &&
+         hasText == other.hasText && canPaste == other.canPaste &&
+         vimMode == other.vimMode && editorMode == other.editorMode &&
+         editorGrammar == other.editorGrammar &&
+         line == other.line && column == other.column &&
+         characters == other.characters && words == other.words &&
+         zoomPercent == other.zoomPercent;
+}
+
+StatusBarManager::TopStatusInputs
+StatusBarManager::collectTopStatusInputs(EditorWidget *currentEditor) const {
+  TopStatusInputs inputs;
+  inputs.editor = currentEditor;
+  inputs.canPaste = QApplication::clipboard()->mimeData()->hasText();
+  if (currentEditor) {
+    const QTextCursor cursor = currentEditor->textCursor();
+    inputs.modified = currentEditor->document()->isModified();
+    inputs.hasText = !currentEditor->document()->isEmpty();
+    inputs.vimMode = static_cast<int>(currentEditor->currentVimMode());
+    inputs.editorMode = static_cast<int>(currentEditor->editorMode());
+    inputs.editorGrammar = currentEditor->editorGrammar();
+    inputs.line = currentEditor->currentLineIndex();
+    inputs.column = cursor.columnNumber();
+    inputs.zoomPercent = currentEditor->currentZoomPercent();
+    if (const auto *stats = currentEditor->documentStats()) {
+      inputs.characters = stats->characterCount();
+      inputs.words = stats->wordCount();
+    }
+  }
+  return inputs;
+}
+
 void StatusBarManager::updateTopStatusBar(EditorWidget *currentEditor) {
+  const TopStatusInputs inputs = collectTopStatusInputs(currentEditor);
+  if (hasTopInputs && inputs == lastTopInputs)
+    return;
+  lastTopInputs = inputs;
+  hasTopInputs = true;
+
   bool editorExists = (currentEditor != nullptr);
-  bool modified = editorExists && currentEditor->document()->isModified();
-  bool hasText = editorExists && !currentEditor->document()->isEmpty();
-  bool canPaste = QApplication::clipboard()->mimeData()->hasText();
+  bool modified = inputs.modified;
+  bool hasText = inputs.hasText;
+  bool canPaste = inputs.canPaste;
 
   if (vimStatusLabel) {
     QString iT = "", mT = "---";
@@ -320,7 +395,7 @@ void StatusBarManager::updateTopStatusBar(EditorWidget *currentEditor) {
     QIcon mI;
     if (editorExists) {
       Constants::EditorFileType cT = currentEditor->editorMode();
-      mT = Constants::editorModeToString(cT);
+      mT = currentEditor->editorModeLabel();
       if (awesome) {
         using namespace fa;
         icon_enum iE = Jino::App::getIconForFileType(cT);
@@ -337,7 +412,7 @@ void StatusBarManager::updateTopStatusBar(EditorWidget *currentEditor) {
     QString lt = "---";
     if (editorExists)
       lt = Constants::STATUS_POS_LINE_FMT.arg(
-          currentEditor->textCursor().blockNumber() + 1);
+          currentEditor->currentLineIndex() + 1);
     lineButton->setText(lt);
     lineButton->setEnabled(editorExists);
   }
@@ -394,10 +469,10 @@ void StatusBarManager::updateEditorStats(EditorWidget *currentEditor) {
   QString charIconText = "";
   QString wordIconText = "";
 
-  if (currentEditor && currentEditor->document()) {
-    const int charCount = currentEditor->document()->characterCount() - 1;
-    const QStringList words = currentEditor->toPlainText().split(
-        QRegExp("\\\\s+"), Qt::SkipEmptyParts);
+  if (currentEditor && currentEditor->documentStats()) {
+    const Jino::Editor::DocumentStats *stats = currentEditor->documentStats();
+    const int charCount = stats->characterCount();
+    const int wordCount = stats->wordCount();
     if (awesome) {
 
       charIconText = QString(QChar(static_cast<int>(fa_font))) + " ";
@@ -407,7 +482,7 @@ void StatusBarManager::updateEditorStats(EditorWidget *currentEditor) {
                    .arg(charCount)
                    .trimmed();
     wordText = Constants::STATUS_STATS_WORDS_FMT.arg(wordIconText)
-                   .arg(words.count())
+                   .arg(wordCount)
                    .trimmed();
   }
 
@@ -443,4 +518,54 @@ void StatusBarManager::updateZoomDisplay(int zoomPercent) {
 }
 void StatusBarManager::handleZoomWidgetClicked() { emit resetZoomRequested(); }
 
+void StatusBarManager::showLoadProgress(const QString &fileName, int percent) {
+  if (!loadProgressBar || !cancelLoadButton)
+    return;
+  const QString tip = Constants::STATUS_FILE_LOADING.arg(fileName);
+  loadProgressBar->setValue(percent);
+  loadProgressBar->setToolTip(tip + QString(" (%1%)").arg(percent));
+  loadProgressBar->show();
+  cancelLoadButton->show();
+}
+
+void StatusBarManager::updatePersistDisplay(qint64 msecsSincePersist,
+                                            bool dirty, bool editorExists) {
+  if (!persistLabel)
+    return;
+  if (!editorExists) {
+    persistLabel->clear();
+    persistLabel->setToolTip("");
+    return;
+  }
+  QString ago = "---";
+  if (msecsSincePersist >= 0) {
+    const qint64 s = msecsSincePersist / 1000;
+    if (s < 60)
+      ago = QString("%1s").arg(s);
+    else if (s < 60 * 60)
+      ago = QString("%1m").arg(s / 60);
+    else
+      ago = QString("%1h").arg(s / (60 * 60));
+  }
+  QString iconText = "";
+  if (awesome)
+    iconText = QString(QChar(static_cast<int>(fa::fa_floppy_disk))) + " ";
+  persistLabel->setText(
+      Constants::STATUS_PERSIST_FMT.arg(iconText).arg(ago).trimmed() +
+      (dirty ? "*" : ""));
+  persistLabel->setToolTip(
+      msecsSincePersist < 0
+          ? QString("Not persisted yet")
+          : QString("Last persisted %1 ago%2")
+                .arg(ago)
+                .arg(dirty ? ", unsaved changes pending" : ""));
+}
+
+void StatusBarManager::hideLoadProgress() {
+  if (loadProgressBar)
+    loadProgressBar->hide();
+  if (cancelLoadButton)
+    cancelLoadButton->hide();
+}
+
 } // namespace Jino::App
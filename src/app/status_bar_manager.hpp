@@ -17,6 +17,7 @@ class QStatusBar;
 class EditorWidget;
 class QToolButton;
 class QHBoxLayout;
+class QProgressBar;
 
 namespace fa {
 class QtAwesome;
@@ -40,6 +41,10 @@ public:
   void setupUI();
   void updateTimeDisplay(const QString &timeString);
   QWidget *getEditorModeWidget() const;
+  void showLoadProgress(const QString &fileName, int percent);
+  void hideLoadProgress();
+  void updatePersistDisplay(qint64 msecsSincePersist, bool dirty,
+                            bool editorExists);
 
 public slots:
   void updateTopStatusBar(EditorWidget *currentEditor);
@@ -59,13 +64,32 @@ signals:
   void goToBottomRequested();
   void pasteAndReplaceRequested();
   void clearFileRequested();
+  void cancelLoadRequested();
 
 private slots:
   void handleZoomWidgetClicked();
 
 private:
+  struct TopStatusInputs {
+    EditorWidget *editor = nullptr;
+    bool modified = false;
+    bool hasText = false;
+    bool canPaste = false;
+    int vimMode = -1;
+    int editorMode = -1;
+    QString editorGrammar;
+    int line = -1;
+    int column = -1;
+    int characters = -1;
+    int words = -1;
+    int zoomPercent = -1;
+
+    bool operator==(const TopStatusInputs &other) const;
+  };
+
   void createTopStatusBar();
   void setupMainStatusBar();
+  TopStatusInputs collectTopStatusInputs(EditorWidget *currentEditor) const;
 
   QMainWindow *mainWindow;
   QString currentWorkspaceName;
@@ -92,6 +116,12 @@ private:
   QPointer<QToolButton> zoomWidget;
 
   QPointer<QLabel> statusBarWorkspaceLabel;
+  QPointer<QLabel> persistLabel;
+  QPointer<QProgressBar> loadProgressBar;
+  QPointer<QToolButton> cancelLoadButton;
+
+  TopStatusInputs lastTopInputs;
+  bool hasTopInputs = false;
 };
 
 } // namespace Jino::App
@@ -0,0 +1,39 @@
+#include "app/ui_refresh_scheduler.hpp"
+
+#include <QTimer>
+
+namespace Jino::App {
+
+UiRefreshScheduler::UiRefreshScheduler(QObject *parent)
+    : QObject(parent), flushTimer(new QTimer(this)) {
+  flushTimer->setSingleShot(true);
+  flushTimer->setInterval(0);
+  connect(flushTimer, &QTimer::timeout, this, &UiRefreshScheduler::flushNow);
+}
+
+void UiRefreshScheduler::markDirty(Parts parts) {
+  if (parts == NoPart)
+    return;
+  ++requests;
+  dirtyParts |= parts;
+  if (!flushTimer->isActive())
+    flushTimer->start();
+}
+
+void UiRefreshScheduler::flushNow() {
+  flushTimer->stop();
+  if (dirtyParts == NoPart)
+    return;
+  const Parts parts = dirtyParts;
+  dirtyParts = NoPart;
+  ++flushes;
+  emit flushRequested(parts);
+}
+
+quint64 UiRefreshScheduler::requestCount() const { return requests; }
+quint64 UiRefreshScheduler::flushCount() const { return flushes; }
+quint64 UiRefreshScheduler::savedFlushCount() const {
+  return requests > flushes ? requests - flushes : 0;
+}
+
+} // namespace Jino::App
@@ -0,0 +1,48 @@
+// src/app/ui_refresh_scheduler.hpp
+#pragma once
+
+#include <QFlags>
+#include <QObject>
+
+class QTimer;
+
+namespace Jino::App {
+
+// Collects "this part of the UI is stale" requests and flushes them once per
+// event-loop turn, so a burst of editor signals costs a single refresh.
+class UiRefreshScheduler : public QObject {
+  Q_OBJECT
+
+public:
+  enum Part {
+    NoPart = 0x0,
+    TopStatusBar = 0x1,
+    ActionStates = 0x2,
+    BuffersMenu = 0x4,
+    WindowTitle = 0x8,
+    AllParts = TopStatusBar | ActionStates | BuffersMenu | WindowTitle
+  };
+  Q_DECLARE_FLAGS(Parts, Part)
+
+  explicit UiRefreshScheduler(QObject *parent = nullptr);
+
+  void markDirty(Parts parts);
+  void flushNow();
+
+  quint64 requestCount() const;
+  quint64 flushCount() const;
+  quint64 savedFlushCount() const;
+
+signals:
+  void flushRequested(Jino::App::UiRefreshScheduler::Parts parts);
+
+private:
+  QTimer *flushTimer;
+  Parts dirtyParts = NoPart;
+  quint64 requests = 0;
+  quint64 flushes = 0;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(UiRefreshScheduler::Parts)
+
+} // namespace Jino::App
@@ -11,7 +11,7 @@
 
 namespace Jino::Constants {
 
-enum class EditorFileType { Text, Org, Markdown };
+enum class EditorFileType { Text, Org, Markdown, Code, LargeFile };
 inline QString editorModeToString(EditorFileType mode) {
   switch (mode) {
   case EditorFileType::Text:
@@ -20,13 +20,14 @@ inline QString editorModeToString(EditorFileType mode) {
     return QStringLiteral("Org");
   case EditorFileType::Markdown:
     return QStringLiteral("MD");
+  case EditorFileType::Code:
+    return QStringLiteral("Code");
+  case EditorFileType::LargeFile:
+    return QStringLiteral("Large");
   default:
     return QStringLiteral("???");
   }
 }
-inline QVector<EditorFileType> getAllEditorModes() {
-  return {EditorFileType::Text, EditorFileType::Org, EditorFileType::Markdown};
-}
 
 const QString APP_NAME = "Jino ✨";
 const QString APP_ORGANIZATION_NAME = "JinoDev";
@@ -47,6 +48,8 @@ const QString DEFAULT_NOTES_DIR = QDir::homePath() + "/Notes/txt";
 const QByteArray DEFAULT_FILE_ENCODING = "UTF-8";
 
 const int MAX_TABS_PER_WORKSPACE = 13;
+const QString JOURNAL_FILE_SUFFIX = ".journal";
+const qint64 DEFAULT_LARGE_FILE_THRESHOLD_BYTES = 64LL * 1024 * 1024;
 
 const QString THEME_EVERFOREST = "everforest";
 const QString THEME_TOKYO_NIGHT = "tokyo_night";
@@ -88,12 +91,8 @@ const QKeySequence KB_CTRL_D = QKeySequence(Qt::CTRL | Qt::Key_D);
 const char VIM_KEY_LEADER = ' ';
 const char VIM_KEY_INSERT_MODE = 'i';
 const char VIM_KEY_UNDO = 'u';
-const char VIM_KEY_CUT_CHAR = 'x';
-const char VIM_KEY_COPY_LINE = 'y';
-const char VIM_KEY_DELETE_LINE = 'd';
-const char VIM_KEY_PASTE = 'p';
-const QString VIM_CMD_DELETE_LINE = "dd";
-const QString VIM_CMD_COPY_LINE = "yy";
+const int VIM_SHIFT_WIDTH = 4;
+const int VIM_MAX_MACRO_DEPTH = 100;
 const QString VIM_LEADER_FILE_SEQUENCE = "f";
 const char VIM_LEADER_FILE_SAVE_KEY = 's';
 const char VIM_LEADER_FILE_SAVEAS_KEY = 'S';
@@ -101,8 +100,17 @@ const char VIM_LEADER_FILE_SAVEAS_KEY = 'S';
 const QString STATUS_READY = "Ready";
 const QString STATUS_FILE_OPENED = "Opened: %1";
 const QString STATUS_FILE_SAVED = "Saved: %1";
+const QString STATUS_FILE_SAVING = "Saving: %1";
 const QString STATUS_FILE_SAVE_FAILED = "Failed to save: %1";
 const QString STATUS_FILE_OPEN_FAILED = "Failed to open: %1";
+const QString STATUS_FILE_LOADING = "Loading: %1";
+const QString STATUS_FILE_LOAD_CANCELED = "Canceled loading: %1";
+const QString STATUS_FILE_STILL_LOADING = "Still loading: %1";
+const QString STATUS_PERSIST_FMT = "%1%2";
+const QString STATUS_BUFFERS_RECOVERED = "Recovered %1 unsaved buffer(s)";
+const QString STATUS_FILE_READ_ONLY_VIEW = "Read-only large file view: %1";
+const QString STATUS_FILE_LOAD_INCOMPLETE =
+    "Read-only, the file could not be read completely: %1";
 const QString STATUS_FONT_LOAD_FAILED = "Failed to load font: %1";
 const QString STATUS_VIM_MODE_FMT = "%1 %2";
 const QString STATUS_EDITOR_MODE_FMT = "%1 %2";
@@ -137,6 +145,8 @@ const QString WORKSPACE_PREFIX = "jino_";
 const int MAX_RECENT_FILES = 25;
 const QString SETTINGS_KEY_RECENT_FILES = "recentFiles";
 const QString SETTINGS_KEY_WORKSPACE_INDEX = "workspaceIndex";
+const QString SETTINGS_KEY_SINGLE_INSTANCE = "singleInstance";
+const QString SETTINGS_KEY_LARGE_FILE_THRESHOLD = "largeFileThresholdBytes";
 
 const QString INPUT_GOTO_LINE_TITLE = "Go To Line";
 const QString INPUT_GOTO_LINE_LABEL = "Line number:";
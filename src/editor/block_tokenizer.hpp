@@ -0,0 +1,27 @@
+// src/editor/block_tokenizer.hpp
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+namespace Jino::Editor {
+
+struct TokenSpan {
+  int start;
+  int length;
+  int token;
+};
+
+// Splits one block of text into token spans for a highlighter. Tokenizers
+// keep no state between calls: they run on worker threads over copies of
+// the block text, possibly on two threads at once. Spans may overlap, in
+// which case a later span wins. Returns the state the next block starts in.
+class BlockTokenizer {
+public:
+  virtual ~BlockTokenizer() = default;
+
+  virtual int tokenize(const QString &text, int previousState,
+                       QVector<TokenSpan> &spans) const = 0;
+};
+
+} // namespace Jino::Editor
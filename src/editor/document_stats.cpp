@@ -0,0 +1,81 @@
+#include "editor/document_stats.hpp"
+
+#include <QPointer>
+#include <QTextBlock>
+#include <QTextBlockUserData>
+#include <QTextDocument>
+
+namespace Jino::Editor {
+
+namespace {
+int countWords(const QString &text) {
+  int words = 0;
+  bool inWord = false;
+  for (const QChar c : text) {
+    const bool space = c.isSpace();
+    if (!space && !inWord)
+      ++words;
+    inWord = !space;
+  }
+  return words;
+}
+} // namespace
+
+// Lives on each block so that blocks merged away or removed by an edit take
+// their word count out of the total when Qt deletes them.
+class BlockStatsData : public QTextBlockUserData {
+public:
+  BlockStatsData(DocumentStats *owner, int words)
+      : owner(owner), words(words) {}
+  ~BlockStatsData() override {
+    if (owner)
+      owner->totalWords -= words;
+  }
+
+  QPointer<DocumentStats> owner;
+  int words;
+};
+
+DocumentStats::DocumentStats(QTextDocument *document)
+    : QObject(document), document(document) {
+  connect(document, &QTextDocument::contentsChange, this,
+          &DocumentStats::handleContentsChange);
+  totalCharacters = qMax(0, document->characterCount() - 1);
+  recountBlocks(document->firstBlock(), document->lastBlock());
+}
+
+int DocumentStats::characterCount() const { return totalCharacters; }
+int DocumentStats::wordCount() const { return qMax(0, totalWords); }
+
+void DocumentStats::handleContentsChange(int position, int charsRemoved,
+                                         int charsAdded) {
+  Q_UNUSED(charsRemoved);
+  totalCharacters = qMax(0, document->characterCount() - 1);
+  QTextBlock first = document->findBlock(position);
+  QTextBlock last = document->findBlock(position + charsAdded);
+  if (!first.isValid())
+    first = document->lastBlock();
+  if (!last.isValid())
+    last = document->lastBlock();
+  recountBlocks(first, last);
+  emit statsChanged();
+}
+
+void DocumentStats::recountBlocks(const QTextBlock &first,
+                                  const QTextBlock &last) {
+  for (QTextBlock block = first; block.isValid(); block = block.next()) {
+    const int words = countWords(block.text());
+    auto *data = static_cast<BlockStatsData *>(block.userData());
+    if (data) {
+      totalWords += words - data->words;
+      data->words = words;
+    } else {
+      totalWords += words;
+      block.setUserData(new BlockStatsData(this, words));
+    }
+    if (block == last)
+      break;
+  }
+}
+
+} // namespace Jino::Editor
@@ -0,0 +1,41 @@
+// src/editor/document_stats.hpp
+#pragma once
+
+#include <QObject>
+
+class QTextBlock;
+class QTextDocument;
+
+namespace Jino::Editor {
+
+class BlockStatsData;
+
+// Keeps character and word totals for a document up to date from
+// contentsChange deltas. Word counts are cached per block, so an edit only
+// rescans the blocks it touched.
+class DocumentStats : public QObject {
+  Q_OBJECT
+
+public:
+  explicit DocumentStats(QTextDocument *document);
+
+  int characterCount() const;
+  int wordCount() const;
+
+signals:
+  void statsChanged();
+
+private slots:
+  void handleContentsChange(int position, int charsRemoved, int charsAdded);
+
+private:
+  friend class BlockStatsData;
+
+  void recountBlocks(const QTextBlock &first, const QTextBlock &last);
+
+  QTextDocument *document;
+  int totalCharacters = 0;
+  int totalWords = 0;
+};
+
+} // namespace Jino::Editor
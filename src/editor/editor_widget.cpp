@@ -1,34 +1,44 @@
 #include "editor/editor_widget.hpp"
 #include "core/constants.hpp"
+#include "editor/document_stats.hpp"
+#include "editor/grammar_syntax_highlighter.hpp"
+#include "editor/large_file_view.hpp"
+#include "editor/layout_cache.hpp"
 #include "editor/line_number_widget.hpp"
 #include "editor/markdown_syntax_highlighter.hpp"
 #include "editor/org_syntax_highlighter.hpp"
+#include "editor/syntax/syntax_registry.hpp"
 #include "editor/vim/vim_handler.hpp"
 
-#include <QAbstractTextDocumentLayout>
 #include <QApplication>
 #include <QClipboard>
 #include <QDebug>
 #include <QFontMetrics>
 #include <QKeyEvent>
 #include <QMimeData>
-#include <QPainter>
+#include <QPaintEvent>
 #include <QResizeEvent>
 #include <QScrollBar>
 #include <QTextBlock>
 #include <QTextCursor>
 #include <QTextDocument>
 #include <QWheelEvent>
+#include <QtMath>
 
 EditorWidget::EditorWidget(QWidget *parent)
-    : QTextEdit(parent), vimHandler(new Jino::Editor::Vim::VimHandler(this)),
-      lineNumberWidget(new LineNumberWidget(this)) {
+    : QPlainTextEdit(parent),
+      vimHandler(new Jino::Editor::Vim::VimHandler(this)),
+      lineNumberWidget(new LineNumberWidget(this)),
+      stats(new Jino::Editor::DocumentStats(document())),
+      layoutCache(new Jino::Editor::LayoutCache(document(), this)) {
 
   defaultCursorWidth = 1;
   connect(this->document(), &QTextDocument::blockCountChanged, this,
           &EditorWidget::updateLineNumberAreaWidth);
+  connect(this, &QPlainTextEdit::updateRequest, this,
+          &EditorWidget::updateLineNumberRows);
   connect(this, &EditorWidget::cursorPositionChanged, this,
-          &EditorWidget::updateLineNumberArea);
+          &EditorWidget::updateCurrentLineNumber);
   connect(vimHandler, &Jino::Editor::Vim::VimHandler::modeChanged, this,
           &EditorWidget::vimModeChanged);
   connect(vimHandler, &Jino::Editor::Vim::VimHandler::saveFileRequested, this,
@@ -48,8 +58,15 @@ Jino::Editor::Vim::Mode EditorWidget::currentVimMode() const {
                     : Jino::Editor::Vim::Mode::Insert;
 }
 
-void EditorWidget::setEditorMode(Jino::Constants::EditorFileType mode) {
-  if (currentEditorMode == mode) {
+void EditorWidget::setEditorMode(Jino::Constants::EditorFileType mode,
+                                 const QString &grammar) {
+  if (largeFileView)
+    mode = Jino::Constants::EditorFileType::LargeFile;
+  else if (mode == Jino::Constants::EditorFileType::LargeFile)
+    return;
+  const QString modeGrammar =
+      mode == Jino::Constants::EditorFileType::Code ? grammar : QString();
+  if (currentEditorMode == mode && currentGrammar == modeGrammar) {
     if ((mode != Jino::Constants::EditorFileType::Text && !syntaxHighlighter) ||
         (mode == Jino::Constants::EditorFileType::Text && syntaxHighlighter)) {
     } else {
@@ -57,19 +74,26 @@ void EditorWidget::setEditorMode(Jino::Constants::EditorFileType mode) {
     }
   }
   currentEditorMode = mode;
-  setupSyntaxHighlighter(currentEditorMode);
-  if (syntaxHighlighter)
-    syntaxHighlighter->rehighlight();
-  else {
-    this->document()->markContentsDirty(
-        0, this->document()->toPlainText().length());
-  }
+  currentGrammar = modeGrammar;
+  // A highlighter starts tokenizing on its own and the next paint asks for
+  // the visible blocks first; a removed one clears its formats.
+  setupSyntaxHighlighter(currentEditorMode, currentGrammar);
+  viewport()->update();
 }
 Jino::Constants::EditorFileType EditorWidget::editorMode() const {
   return currentEditorMode;
 }
+QString EditorWidget::editorGrammar() const { return currentGrammar; }
+QString EditorWidget::editorModeLabel() const {
+  return Jino::Editor::Syntax::FileMode{currentEditorMode, currentGrammar}
+      .label();
+}
+const Jino::Editor::DocumentStats *EditorWidget::documentStats() const {
+  return stats;
+}
+
 void EditorWidget::setupSyntaxHighlighter(
-    Jino::Constants::EditorFileType mode) {
+    Jino::Constants::EditorFileType mode, const QString &grammar) {
   if (syntaxHighlighter) {
     delete syntaxHighlighter;
     syntaxHighlighter = nullptr;
@@ -83,6 +107,12 @@ void EditorWidget::setupSyntaxHighlighter(
     syntaxHighlighter =
         new Jino::Editor::MarkdownSyntaxHighlighter(this->document());
     break;
+  case Jino::Constants::EditorFileType::Code:
+    if (auto loaded = Jino::Editor::Syntax::Registry::instance().grammar(
+            grammar))
+      syntaxHighlighter = new Jino::Editor::GrammarSyntaxHighlighter(
+          this->document(), loaded);
+    break;
   case Jino::Constants::EditorFileType::Text:
   default:
     syntaxHighlighter = nullptr;
@@ -91,6 +121,11 @@ void EditorWidget::setupSyntaxHighlighter(
 }
 
 void EditorWidget::keyPressEvent(QKeyEvent *event) {
+  if (largeFileView) {
+    if (!largeFileView->handleKey(event))
+      vimHandler->handleKeyPress(event);
+    return;
+  }
 
   if (currentVimMode() == Jino::Editor::Vim::Mode::Insert) {
     if (event->matches(QKeySequence::Cut) ||
@@ -103,19 +138,20 @@ void EditorWidget::keyPressEvent(QKeyEvent *event) {
   }
   const bool handledByVim = vimHandler->handleKeyPress(event);
   if (!handledByVim && currentVimMode() != Jino::Editor::Vim::Mode::Normal) {
-    QTextEdit::keyPressEvent(event);
+    QPlainTextEdit::keyPressEvent(event);
   }
 }
 
 void EditorWidget::insertFromMimeData(const QMimeData *source) {
-  if (currentEditorMode == Jino::Constants::EditorFileType::Text &&
+  if ((currentEditorMode == Jino::Constants::EditorFileType::Text ||
+       currentEditorMode == Jino::Constants::EditorFileType::Code) &&
       source->hasText()) {
     QMimeData *plainTextData = new QMimeData();
     plainTextData->setText(source->text());
-    QTextEdit::insertFromMimeData(plainTextData);
+    QPlainTextEdit::insertFromMimeData(plainTextData);
     delete plainTextData;
   } else {
-    QTextEdit::insertFromMimeData(source);
+    QPlainTextEdit::insertFromMimeData(source);
   }
 }
 
@@ -128,7 +164,7 @@ void EditorWidget::wheelEvent(QWheelEvent *e) {
       zoomOut();
     e->accept();
   } else {
-    QTextEdit::wheelEvent(e);
+    QPlainTextEdit::wheelEvent(e);
   }
 }
 
@@ -144,6 +180,7 @@ void EditorWidget::setZoom(int percent) {
   qreal nS = Jino::Constants::FONT_SIZE_PT * f;
   cF.setPointSizeF(nS);
   setFont(cF);
+  layoutCache->refine(0);
   emit zoomPercentChanged(currentZoomLevelPercent);
   updateLineNumberAreaWidth();
 }
@@ -171,26 +208,89 @@ int EditorWidget::calculateLineNumberWidth() const {
 }
 void EditorWidget::updateLineNumberAreaWidth() {
   setViewportMargins(calculateLineNumberWidth(), 0, 0, 0);
+  updateLineNumberArea();
 }
 void EditorWidget::triggerLineNumberUpdate() const { updateLineNumberArea(); }
 void EditorWidget::updateLineNumberArea() const {
   if (lineNumberWidget)
     lineNumberWidget->update();
 }
+QTextBlock EditorWidget::firstVisibleTextBlock() const {
+  return firstVisibleBlock();
+}
+qreal EditorWidget::blockViewportTop(const QTextBlock &block) const {
+  return blockBoundingGeometry(block).translated(contentOffset()).top();
+}
+void EditorWidget::updateLineNumberRows(const QRect &rect, int dy) const {
+  if (!lineNumberWidget)
+    return;
+  if (dy)
+    lineNumberWidget->scroll(0, dy);
+  else
+    lineNumberWidget->update(0, rect.y(), lineNumberWidget->width(),
+                             rect.height());
+}
+void EditorWidget::updateCurrentLineNumber() {
+  const int currentBlock = textCursor().blockNumber();
+  if (currentBlock == highlightedLineNumberBlock)
+    return;
+  const int previousBlock = highlightedLineNumberBlock;
+  highlightedLineNumberBlock = currentBlock;
+  if (!lineNumberWidget)
+    return;
+  // Rows outside the viewport have nothing to repaint, and measuring the
+  // position of a line far away would lay out every block in between.
+  const int firstBlock = firstVisibleBlock().blockNumber();
+  const int lastBlock = lastVisibleBlockNumber();
+  for (int blockNumber : {previousBlock, currentBlock}) {
+    if (blockNumber < firstBlock || blockNumber > lastBlock)
+      continue;
+    const QRectF row =
+        blockBoundingGeometry(document()->findBlockByNumber(blockNumber))
+            .translated(contentOffset());
+    lineNumberWidget->update(0, qFloor(row.top()), lineNumberWidget->width(),
+                             qCeil(row.height()) + 1);
+  }
+}
 void EditorWidget::resizeEvent(QResizeEvent *e) {
-  QTextEdit::resizeEvent(e);
+  QPlainTextEdit::resizeEvent(e);
+  if (e->size().width() != e->oldSize().width())
+    layoutCache->refine(0);
   if (lineNumberWidget) {
     QRect cr = contentsRect();
     lineNumberWidget->setGeometry(
         QRect(cr.left(), cr.top(), calculateLineNumberWidth(), cr.height()));
+    updateLineNumberArea();
+  }
+  if (largeFileView)
+    largeFileView->setGeometry(rect());
+}
+int EditorWidget::lastVisibleBlockNumber() const {
+  const int viewportBottom = viewport()->height();
+  QTextBlock block = firstVisibleBlock();
+  qreal top = blockViewportTop(block);
+  while (block.next().isValid() && top <= viewportBottom) {
+    top += blockBoundingRect(block).height();
+    block = block.next();
   }
+  return block.blockNumber();
 }
-void EditorWidget::scrollContentsBy(int dx, int dy) {
-  QTextEdit::scrollContentsBy(dx, dy);
-  updateLineNumberArea();
+void EditorWidget::paintEvent(QPaintEvent *e) {
+  const int firstBlock = firstVisibleBlock().blockNumber();
+  const int lastBlock = lastVisibleBlockNumber();
+  // Blocks the highlighter has not reached yet are highlighted before they
+  // are painted rather than showing up plain until the idle pass gets there.
+  if (syntaxHighlighter)
+    syntaxHighlighter->highlightBlocks(firstBlock, lastBlock);
+  QPlainTextEdit::paintEvent(e);
+  layoutCache->touch(firstBlock, lastBlock);
 }
 
 void EditorWidget::goToLine(int lineNum) {
+  if (largeFileView) {
+    largeFileView->goToLine(lineNum - 1);
+    return;
+  }
   if (lineNum < 1 || lineNum > document()->blockCount()) {
     qWarning() << "Go To Line: Invalid line number" << lineNum;
     return;
@@ -211,12 +311,20 @@ void EditorWidget::goToColumn(int colNum) {
   ensureCursorVisible();
 }
 void EditorWidget::goToTop() {
+  if (largeFileView) {
+    largeFileView->goToTop();
+    return;
+  }
   QTextCursor cursor = textCursor();
   cursor.movePosition(QTextCursor::Start);
   setTextCursor(cursor);
   ensureCursorVisible();
 }
 void EditorWidget::goToCenter() {
+  if (largeFileView) {
+    largeFileView->goToCenter();
+    return;
+  }
   int totalBlocks = document()->blockCount();
   int centerBlock = qMax(0, (totalBlocks / 2) - 1);
   QTextCursor cursor(document()->findBlockByNumber(centerBlock));
@@ -224,6 +332,10 @@ void EditorWidget::goToCenter() {
   ensureCursorVisible();
 }
 void EditorWidget::goToBottom() {
+  if (largeFileView) {
+    largeFileView->goToBottom();
+    return;
+  }
   QTextCursor cursor = textCursor();
   cursor.movePosition(QTextCursor::End);
   setTextCursor(cursor);
@@ -231,16 +343,22 @@ void EditorWidget::goToBottom() {
 }
 
 void EditorWidget::pasteAndReplace() {
+  if (editingLocked())
+    return;
   const QClipboard *cb = QApplication::clipboard();
   const QMimeData *md = cb->mimeData();
   if (md->hasText())
     this->setPlainText(md->text());
 }
 void EditorWidget::clearAll() {
+  if (editingLocked())
+    return;
   this->selectAll();
   this->textCursor().removeSelectedText();
 }
 void EditorWidget::deleteCurrentLine() {
+  if (editingLocked())
+    return;
   QTextCursor c = textCursor();
   c.beginEditBlock();
   c.select(QTextCursor::LineUnderCursor);
@@ -255,7 +373,7 @@ void EditorWidget::deleteCurrentLine() {
 void EditorWidget::vimSetMode(Jino::Editor::Vim::Mode newMode) {
   const bool ro = (newMode == Jino::Editor::Vim::Mode::Normal ||
                    newMode == Jino::Editor::Vim::Mode::Visual);
-  setReadOnly(ro);
+  setReadOnly(ro || editingLocked());
   if (ro) {
     setOverwriteMode(true);
     int bw = fontMetrics().averageCharWidth();
@@ -265,53 +383,79 @@ void EditorWidget::vimSetMode(Jino::Editor::Vim::Mode newMode) {
     setCursorWidth(defaultCursorWidth);
   }
 }
-void EditorWidget::vimDeleteLine() { deleteCurrentLine(); }
-void EditorWidget::vimCopyLine() {
-  QTextCursor c = textCursor();
-  c.select(QTextCursor::LineUnderCursor);
-  if (document()->findBlockByNumber(c.blockNumber() + 1).isValid())
-    c.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
-  const QString t = c.selectedText();
-  if (!t.isEmpty())
-    QApplication::clipboard()->setText(t);
-  c.clearSelection();
-  c.movePosition(QTextCursor::StartOfLine);
-  setTextCursor(c);
-}
-void EditorWidget::vimCutSelection() {
-  QTextCursor c = textCursor();
-  if (!c.hasSelection())
+void EditorWidget::setLoading(bool loading) {
+  if (loadingInProgress == loading)
     return;
-  c.beginEditBlock();
-  QApplication::clipboard()->setText(c.selectedText());
-  c.removeSelectedText();
-  c.endEditBlock();
-  setTextCursor(c);
+  loadingInProgress = loading;
+  vimSetMode(currentVimMode());
 }
-void EditorWidget::vimCopySelection() {
-  QTextCursor c = textCursor();
-  if (!c.hasSelection())
+bool EditorWidget::isLoading() const { return loadingInProgress; }
+void EditorWidget::setLoadIncomplete(bool incomplete) {
+  if (loadIncomplete == incomplete)
     return;
-  const QString t = c.selectedText();
-  if (!t.isEmpty())
-    QApplication::clipboard()->setText(t);
-  c.setPosition(c.selectionStart());
-  setTextCursor(c);
+  loadIncomplete = incomplete;
+  vimSetMode(currentVimMode());
 }
-void EditorWidget::vimPasteText() {
-  bool ro = isReadOnly();
-  if (ro)
-    setReadOnly(false);
-  QTextCursor c = textCursor();
-  if (isReadOnly()) {
-    c.movePosition(QTextCursor::NextCharacter);
-    setTextCursor(c);
+bool EditorWidget::isLoadIncomplete() const { return loadIncomplete; }
+bool EditorWidget::editingLocked() const {
+  return loadingInProgress || loadIncomplete || largeFileView;
+}
+
+bool EditorWidget::openLargeFile(const QString &path) {
+  if (!largeFileView) {
+    largeFileView = new Jino::Editor::LargeFileView(this);
+    connect(largeFileView, &Jino::Editor::LargeFileView::currentLineChanged,
+            this, &EditorWidget::viewLineChanged);
+    connect(largeFileView, &Jino::Editor::LargeFileView::lineCountChanged,
+            this, &EditorWidget::viewLineChanged);
+    connect(largeFileView, &Jino::Editor::LargeFileView::zoomRequested, this,
+            [this](int delta) {
+              if (delta > 0)
+                zoomIn();
+              else if (delta < 0)
+                zoomOut();
+            });
   }
-  paste();
-  if (ro)
-    setReadOnly(true);
+  if (!largeFileView->openFile(path)) {
+    delete largeFileView;
+    return false;
+  }
+  clear();
+  document()->setModified(false);
+  if (lineNumberWidget)
+    lineNumberWidget->hide();
+  largeFileView->setGeometry(rect());
+  largeFileView->show();
+  setEditorMode(Jino::Constants::EditorFileType::LargeFile);
+  vimSetMode(currentVimMode());
+  return true;
+}
+bool EditorWidget::isLargeFileView() const { return largeFileView; }
+int EditorWidget::currentLineIndex() const {
+  return largeFileView ? largeFileView->currentLine()
+                       : textCursor().blockNumber();
+}
+int EditorWidget::lineCount() const {
+  return largeFileView ? largeFileView->lineCount() : document()->blockCount();
+}
+void EditorWidget::beginBatchEdit() {
+  if (batchDepth++ > 0)
+    return;
+  batchCursor = QTextCursor(document());
+  batchCursor.beginEditBlock();
+  setUpdatesEnabled(false);
+}
+void EditorWidget::endBatchEdit() {
+  if (batchDepth == 0 || --batchDepth > 0)
+    return;
+  batchCursor.endEditBlock();
+  batchCursor = QTextCursor();
+  setUpdatesEnabled(true);
+  ensureCursorVisible();
 }
 void EditorWidget::vimUndo() {
+  if (editingLocked())
+    return;
   bool ro = isReadOnly();
   if (ro)
     setReadOnly(false);
@@ -319,22 +463,6 @@ void EditorWidget::vimUndo() {
   if (ro)
     setReadOnly(true);
 }
-void EditorWidget::vimCutChar() {
-  bool ro = isReadOnly();
-  if (ro)
-    setReadOnly(false);
-  QTextCursor c = textCursor();
-  c.beginEditBlock();
-  if (!c.atEnd()) {
-    c.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, 1);
-    if (c.hasSelection())
-      c.removeSelectedText();
-  }
-  c.endEditBlock();
-  if (ro)
-    setReadOnly(true);
-  setTextCursor(c);
-}
 void EditorWidget::vimToggleVisualCharacterMode() {
   QTextCursor c = textCursor();
   if (!c.hasSelection()) {
@@ -6,21 +6,31 @@
 
 #include <QMimeData>
 #include <QPointer>
+#include <QRect>
 #include <QString>
-#include <QSyntaxHighlighter>
-#include <QTextEdit>
+#include <QPlainTextEdit>
+#include <QTextBlock>
+#include <QTextCursor>
 
 class QKeyEvent;
+class QPaintEvent;
 class QResizeEvent;
 class QWidget;
 class LineNumberWidget;
 class QWheelEvent;
 
+namespace Jino::Editor {
+class DocumentStats;
+class LargeFileView;
+class LayoutCache;
+class LazySyntaxHighlighter;
+} // namespace Jino::Editor
+
 namespace Jino::Editor::Vim {
 class VimHandler;
 }
 
-class EditorWidget : public QTextEdit {
+class EditorWidget : public QPlainTextEdit {
   Q_OBJECT
 
 public:
@@ -29,20 +39,39 @@ public:
 
   Jino::Editor::Vim::Mode currentVimMode() const;
 
-  void setEditorMode(Jino::Constants::EditorFileType mode);
+  void setEditorMode(Jino::Constants::EditorFileType mode,
+                     const QString &grammar = QString());
   Jino::Constants::EditorFileType editorMode() const;
+  QString editorGrammar() const;
+  QString editorModeLabel() const;
+
+  const Jino::Editor::DocumentStats *documentStats() const;
+
+  void setLoading(bool loading);
+  bool isLoading() const;
+  // A file that could not be read to the end stays read-only, so the
+  // truncated text can never be written over the whole file.
+  void setLoadIncomplete(bool incomplete);
+  bool isLoadIncomplete() const;
+
+  bool openLargeFile(const QString &path);
+  bool isLargeFileView() const;
+  int currentLineIndex() const;
+  int lineCount() const;
 
   void vimSetMode(Jino::Editor::Vim::Mode newMode);
-  void vimDeleteLine();
-  void vimCopyLine();
-  void vimCutSelection();
-  void vimCopySelection();
-  void vimPasteText();
   void vimUndo();
-  void vimCutChar();
   void vimToggleVisualCharacterMode();
 
+  // Groups programmatic edits into one undo step and holds back repainting
+  // the editor and its gutter until the outermost batch ends. Batches nest.
+  void beginBatchEdit();
+  void endBatchEdit();
+  bool editingLocked() const;
+
   void triggerLineNumberUpdate() const;
+  QTextBlock firstVisibleTextBlock() const;
+  qreal blockViewportTop(const QTextBlock &block) const;
 
   int currentZoomPercent() const;
 
@@ -66,27 +95,41 @@ signals:
   void saveFileRequested();
   void saveFileAsRequested();
   void zoomPercentChanged(int percent);
+  void viewLineChanged();
 
 protected:
   void keyPressEvent(QKeyEvent *event) override;
   void resizeEvent(QResizeEvent *event) override;
-  void scrollContentsBy(int dx, int dy) override;
+  void paintEvent(QPaintEvent *event) override;
   void insertFromMimeData(const QMimeData *source) override;
   void wheelEvent(QWheelEvent *e) override;
 
 private:
-  void setupSyntaxHighlighter(Jino::Constants::EditorFileType mode);
+  void setupSyntaxHighlighter(Jino::Constants::EditorFileType mode,
+                              const QString &grammar);
   void updateLineNumberAreaWidth();
   void updateLineNumberArea() const;
+  void updateLineNumberRows(const QRect &rect, int dy) const;
+  void updateCurrentLineNumber();
   int calculateLineNumberWidth() const;
+  int lastVisibleBlockNumber() const;
   void setZoom(int percent);
 
   Jino::Editor::Vim::VimHandler *vimHandler;
   QPointer<LineNumberWidget> lineNumberWidget;
-  QSyntaxHighlighter *syntaxHighlighter = nullptr;
+  Jino::Editor::LazySyntaxHighlighter *syntaxHighlighter = nullptr;
+  Jino::Editor::DocumentStats *stats = nullptr;
+  Jino::Editor::LayoutCache *layoutCache = nullptr;
+  QPointer<Jino::Editor::LargeFileView> largeFileView;
 
   Jino::Constants::EditorFileType currentEditorMode =
       Jino::Constants::EditorFileType::Text;
+  QString currentGrammar;
   int defaultCursorWidth = 1;
+  int highlightedLineNumberBlock = -1;
+  int batchDepth = 0;
+  QTextCursor batchCursor;
+  bool loadingInProgress = false;
+  bool loadIncomplete = false;
   int currentZoomLevelPercent = Jino::Constants::EDITOR_DEFAULT_ZOOM_PERCENT;
 };
@@ -0,0 +1,83 @@
+#include "editor/format_palette.hpp"
+
+namespace Jino::Editor {
+
+namespace {
+constexpr int KEY_PROPERTY = QTextFormat::UserProperty + 0x4a50;
+} // namespace
+
+FormatPalette &FormatPalette::instance() {
+  static FormatPalette palette;
+  return palette;
+}
+
+// Palettes hold a few dozen formats, so a linear search is enough; it only
+// runs when a highlighter is created.
+int FormatPalette::intern(const QTextCharFormat &format) {
+  QTextCharFormat plain = format;
+  plain.clearProperty(KEY_PROPERTY);
+  for (int id = 0; id < interned.size(); ++id) {
+    if (interned.at(id) == plain)
+      return id;
+  }
+  interned.append(plain);
+  formats.append(QTextCharFormat());
+  store(formats.size() - 1, themed(plain));
+  return formats.size() - 1;
+}
+
+const QTextCharFormat &FormatPalette::format(int id) const {
+  return formats.at(id);
+}
+
+void FormatPalette::setFormat(int id, const QTextCharFormat &format) {
+  store(id, format);
+  emit formatsChanged({id});
+}
+
+void FormatPalette::setThemeColors(const QHash<QRgb, QColor> &colors) {
+  themeColors = colors;
+  QVector<int> changed;
+  for (int id = 0; id < interned.size(); ++id) {
+    const QTextCharFormat format = themed(interned.at(id));
+    QTextCharFormat current = formats.at(id);
+    current.clearProperty(KEY_PROPERTY);
+    if (current == format)
+      continue;
+    store(id, format);
+    changed.append(id);
+  }
+  if (!changed.isEmpty())
+    emit formatsChanged(changed);
+}
+
+int FormatPalette::keyOf(const QTextCharFormat &format) {
+  const QVariant key = format.property(KEY_PROPERTY);
+  return key.isValid() ? key.toInt() : -1;
+}
+
+bool FormatPalette::sameFormat(const QTextCharFormat &a,
+                               const QTextCharFormat &b) {
+  const int key = keyOf(a);
+  if (key >= 0 || keyOf(b) >= 0)
+    return key == keyOf(b);
+  return a == b;
+}
+
+QTextCharFormat FormatPalette::themed(const QTextCharFormat &format) const {
+  QTextCharFormat result = format;
+  if (format.hasProperty(QTextFormat::ForegroundBrush)) {
+    const QBrush brush = format.foreground();
+    const auto color = themeColors.constFind(brush.color().rgb());
+    if (brush.style() == Qt::SolidPattern && color != themeColors.constEnd())
+      result.setForeground(color.value());
+  }
+  return result;
+}
+
+void FormatPalette::store(int id, QTextCharFormat format) {
+  format.setProperty(KEY_PROPERTY, nextKey++);
+  formats[id] = format;
+}
+
+} // namespace Jino::Editor
@@ -0,0 +1,57 @@
+// src/editor/format_palette.hpp
+#pragma once
+
+#include <QColor>
+#include <QHash>
+#include <QObject>
+#include <QTextCharFormat>
+#include <QVector>
+
+namespace Jino::Editor {
+
+// The character formats of all highlighters, interned: equal formats are
+// stored once and handed out by a small integer id, so every block
+// highlighted with a token shares one format. Each stored format carries a
+// key property that changes whenever its entry is replaced; comparing the
+// formats installed on a block with new ones is a comparison of keys
+// instead of property maps. Entries are replaced in place, so the palette
+// never holds more than one format per id. Replacing entries, one at a time
+// or for a theme change, restyles every highlighter using them. GUI thread
+// only.
+class FormatPalette : public QObject {
+  Q_OBJECT
+
+public:
+  static FormatPalette &instance();
+
+  int intern(const QTextCharFormat &format);
+  const QTextCharFormat &format(int id) const;
+  // Until the next theme change.
+  void setFormat(int id, const QTextCharFormat &format);
+  // Recolours every entry whose foreground, as interned, is a key of
+  // `colors` (by QColor::rgb()); the others get their interned colour back.
+  // Formats interned later take the same colours.
+  void setThemeColors(const QHash<QRgb, QColor> &colors);
+
+  // The key of a palette format, -1 for formats from elsewhere.
+  static int keyOf(const QTextCharFormat &format);
+  static bool sameFormat(const QTextCharFormat &a, const QTextCharFormat &b);
+
+signals:
+  void formatsChanged(const QVector<int> &ids);
+
+private:
+  FormatPalette() = default;
+
+  QTextCharFormat themed(const QTextCharFormat &format) const;
+  void store(int id, QTextCharFormat format);
+
+  // The formats as highlighters asked for them, which intern() matches
+  // against, and as installed, with the theme applied and a key set.
+  QVector<QTextCharFormat> interned;
+  QVector<QTextCharFormat> formats;
+  QHash<QRgb, QColor> themeColors;
+  int nextKey = 0;
+};
+
+} // namespace Jino::Editor
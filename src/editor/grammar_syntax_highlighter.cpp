@@ -0,0 +1,30 @@
+#include "editor/grammar_syntax_highlighter.hpp"
+#include "editor/syntax/grammar.hpp"
+#include "editor/syntax/grammar_tokenizer.hpp"
+
+#include <QFont>
+#include <QTextCharFormat>
+
+namespace Jino::Editor {
+
+GrammarSyntaxHighlighter::GrammarSyntaxHighlighter(
+    QTextDocument *parent, std::shared_ptr<const Syntax::Grammar> grammar)
+    : LazySyntaxHighlighter(
+          parent, grammar->name(),
+          std::make_unique<Syntax::GrammarTokenizer>(grammar)) {
+  const QVector<Syntax::Grammar::Style> &styles = grammar->styles();
+  for (int token = 0; token < styles.size(); ++token) {
+    const Syntax::Grammar::Style &style = styles.at(token);
+    QTextCharFormat format;
+    format.setForeground(style.color);
+    if (style.bold)
+      format.setFontWeight(QFont::Bold);
+    if (style.italic)
+      format.setFontItalic(true);
+    if (style.underline)
+      format.setUnderlineStyle(QTextCharFormat::SingleUnderline);
+    setTokenFormat(token, format);
+  }
+}
+
+} // namespace Jino::Editor
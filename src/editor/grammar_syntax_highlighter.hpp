@@ -0,0 +1,26 @@
+// src/editor/grammar_syntax_highlighter.hpp
+#pragma once
+
+#include "editor/lazy_syntax_highlighter.hpp"
+
+#include <memory>
+
+class QTextDocument;
+
+namespace Jino::Editor {
+
+namespace Syntax {
+class Grammar;
+}
+
+// Highlighting for any language described by a Syntax::Grammar: the
+// grammar's tokenizer on the worker side, its styles here.
+class GrammarSyntaxHighlighter : public LazySyntaxHighlighter {
+  Q_OBJECT
+
+public:
+  GrammarSyntaxHighlighter(QTextDocument *parent,
+                           std::shared_ptr<const Syntax::Grammar> grammar);
+};
+
+} // namespace Jino::Editor
@@ -0,0 +1,81 @@
+#include "editor/highlight_cache.hpp"
+#include "editor/highlight_profiler.hpp"
+
+#include <QDebug>
+
+namespace Jino::Editor {
+
+namespace {
+constexpr int MAX_COST_BYTES = 8 * 1024 * 1024;
+constexpr int ENTRY_OVERHEAD_BYTES = 64;
+// Shorter blocks (blank lines, list bullets) tokenize faster than they hash.
+constexpr int MIN_CACHED_CHARS = 16;
+constexpr qint64 REPORT_EVERY_LOOKUPS = 5000;
+} // namespace
+
+HighlightCache &HighlightCache::instance() {
+  static HighlightCache cache;
+  return cache;
+}
+
+HighlightCache::HighlightCache() : entries(MAX_COST_BYTES) {}
+
+HighlightCache::~HighlightCache() {
+  if (HighlightProfiler::enabled() && totals.hits + totals.misses > 0)
+    report();
+}
+
+HighlightCache::Key HighlightCache::keyFor(const QString &syntax,
+                                           const QString &text,
+                                           int previousState) {
+  return {qHash(text), previousState, syntax};
+}
+
+bool HighlightCache::lookup(const Key &key, const QString &text,
+                            int &outgoingState, QVector<TokenSpan> &spans) {
+  if (text.size() < MIN_CACHED_CHARS)
+    return false;
+  QMutexLocker locker(&mutex);
+  const Entry *entry = entries.object(key);
+  // The text is compared as well, so a hash collision is just a miss.
+  const bool hit = entry && entry->text == text;
+  if (hit) {
+    outgoingState = entry->outgoingState;
+    spans = entry->spans;
+    ++totals.hits;
+    totals.savedChars += text.size();
+  } else {
+    ++totals.misses;
+  }
+  if (HighlightProfiler::enabled() &&
+      (totals.hits + totals.misses) % REPORT_EVERY_LOOKUPS == 0)
+    report();
+  return hit;
+}
+
+void HighlightCache::insert(const Key &key, const QString &text,
+                            int outgoingState,
+                            const QVector<TokenSpan> &spans) {
+  if (text.size() < MIN_CACHED_CHARS)
+    return;
+  const int cost = text.size() * int(sizeof(QChar)) +
+                   spans.size() * int(sizeof(TokenSpan)) +
+                   ENTRY_OVERHEAD_BYTES;
+  QMutexLocker locker(&mutex);
+  entries.insert(key, new Entry{text, outgoingState, spans}, cost);
+}
+
+HighlightCache::Counters HighlightCache::counters() const {
+  QMutexLocker locker(&mutex);
+  return totals;
+}
+
+void HighlightCache::report() const {
+  const qint64 lookups = totals.hits + totals.misses;
+  qInfo().nospace() << "Highlight cache: " << lookups << " lookups, "
+                    << 100.0 * totals.hits / qMax<qint64>(1, lookups)
+                    << "% hits, " << totals.savedChars << " chars saved, "
+                    << entries.totalCost() / 1024 << " KiB held";
+}
+
+} // namespace Jino::Editor
@@ -0,0 +1,74 @@
+// src/editor/highlight_cache.hpp
+#pragma once
+
+#include "editor/block_tokenizer.hpp"
+
+#include <QCache>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+namespace Jino::Editor {
+
+// Tokenizer results shared by all highlighters, keyed by the block text,
+// the state flowing into it and the name of the syntax (built-in mode or
+// grammar). Undo and redo bring back text that was tokenized before, and so
+// do switching a mode off and on again or opening the same notes in another
+// tab; those blocks are served from here instead of running the lexer
+// again. The cache is bounded by
+// memory and safe to use from the tokenizer threads. Hit counters are
+// logged along with the highlight profile (JINO_PROFILE_HIGHLIGHT).
+class HighlightCache {
+public:
+  struct Key {
+    uint textHash;
+    int previousState;
+    QString syntax;
+
+    bool operator==(const Key &other) const {
+      return textHash == other.textHash &&
+             previousState == other.previousState &&
+             syntax == other.syntax;
+    }
+  };
+
+  struct Counters {
+    qint64 hits = 0;
+    qint64 misses = 0;
+    qint64 savedChars = 0;
+  };
+
+  static HighlightCache &instance();
+
+  static Key keyFor(const QString &syntax, const QString &text,
+                    int previousState);
+
+  bool lookup(const Key &key, const QString &text, int &outgoingState,
+              QVector<TokenSpan> &spans);
+  void insert(const Key &key, const QString &text, int outgoingState,
+              const QVector<TokenSpan> &spans);
+  Counters counters() const;
+
+private:
+  struct Entry {
+    QString text;
+    int outgoingState;
+    QVector<TokenSpan> spans;
+  };
+
+  HighlightCache();
+  ~HighlightCache();
+
+  void report() const;
+
+  mutable QMutex mutex;
+  QCache<Key, Entry> entries;
+  Counters totals;
+};
+
+inline uint qHash(const HighlightCache::Key &key, uint seed = 0) {
+  return qHash(key.textHash, seed) ^
+         qHash(uint(key.previousState) * 31u + qHash(key.syntax), seed);
+}
+
+} // namespace Jino::Editor
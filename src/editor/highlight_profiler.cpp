@@ -0,0 +1,51 @@
+#include "editor/highlight_profiler.hpp"
+
+#include <QDebug>
+
+namespace Jino::Editor {
+
+namespace {
+constexpr qint64 REPORT_EVERY_BLOCKS = 5000;
+} // namespace
+
+HighlightProfiler::Scope::Scope(HighlightProfiler &profiler, int characters)
+    : profiler(profiler), characters(characters) {
+  if (HighlightProfiler::enabled())
+    timer.start();
+}
+
+HighlightProfiler::Scope::~Scope() {
+  if (timer.isValid())
+    profiler.record(timer.nsecsElapsed(), characters);
+}
+
+HighlightProfiler::HighlightProfiler(const char *name) : name(name) {}
+
+HighlightProfiler::~HighlightProfiler() {
+  if (blocks > 0)
+    report();
+}
+
+bool HighlightProfiler::enabled() {
+  static const bool on = qEnvironmentVariableIsSet("JINO_PROFILE_HIGHLIGHT");
+  return on;
+}
+
+void HighlightProfiler::record(qint64 nsecs, int characters) {
+  QMutexLocker locker(&mutex);
+  ++blocks;
+  this->characters += characters;
+  totalNsecs += nsecs;
+  if (blocks % REPORT_EVERY_BLOCKS == 0)
+    report();
+}
+
+void HighlightProfiler::report() const {
+  qInfo().nospace() << name << " highlighter: " << blocks << " blocks, "
+                    << characters << " chars, "
+                    << double(totalNsecs) / blocks / 1000.0 << " us/block, "
+                    << double(totalNsecs) / qMax<qint64>(1, characters)
+                    << " ns/char";
+}
+
+} // namespace Jino::Editor
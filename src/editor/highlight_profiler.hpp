@@ -0,0 +1,44 @@
+// src/editor/highlight_profiler.hpp
+#pragma once
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QtGlobal>
+
+namespace Jino::Editor {
+
+// Per-tokenizer timing of tokenize(), enabled by setting the
+// JINO_PROFILE_HIGHLIGHT environment variable. Totals are logged every few
+// thousand blocks and when the tokenizer goes away, which gives the
+// per-block cost of a rehighlight over a real document. Tokenizers run on
+// worker threads, so recording is serialised.
+class HighlightProfiler {
+public:
+  class Scope {
+  public:
+    Scope(HighlightProfiler &profiler, int characters);
+    ~Scope();
+
+  private:
+    HighlightProfiler &profiler;
+    QElapsedTimer timer;
+    int characters;
+  };
+
+  explicit HighlightProfiler(const char *name);
+  ~HighlightProfiler();
+
+  static bool enabled();
+
+private:
+  void record(qint64 nsecs, int characters);
+  void report() const;
+
+  const char *name;
+  QMutex mutex;
+  qint64 blocks = 0;
+  qint64 characters = 0;
+  qint64 totalNsecs = 0;
+};
+
+} // namespace Jino::Editor
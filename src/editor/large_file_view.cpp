@@ -0,0 +1,371 @@
+#include "editor/large_file_view.hpp"
+
+#include <QDebug>
+#include <QEvent>
+#include <QFontMetrics>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPalette>
+#include <QScrollBar>
+#include <QThread>
+#include <QWheelEvent>
+#include <climits>
+#include <cstring>
+
+namespace Jino::Editor {
+
+namespace {
+constexpr qint64 INDEX_BATCH_BYTES = 16 * 1024 * 1024;
+constexpr int MAX_PAINTED_LINE_BYTES = 4096;
+constexpr int GUTTER_PADDING = 3;
+} // namespace
+
+LargeFileView::LargeFileView(QWidget *parent) : QAbstractScrollArea(parent) {
+  setObjectName("LargeFileView");
+  setFocusPolicy(Qt::NoFocus);
+  setFrameShape(QFrame::NoFrame);
+  setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  verticalScrollBar()->setSingleStep(1);
+  qRegisterMetaType<QVector<qint64>>("QVector<qint64>");
+  connect(this, &LargeFileView::indexBatchReady, this,
+          &LargeFileView::handleIndexBatch, Qt::QueuedConnection);
+  connect(verticalScrollBar(), &QScrollBar::valueChanged, viewport(),
+          QOverload<>::of(&QWidget::update));
+}
+
+LargeFileView::~LargeFileView() { closeFile(); }
+
+bool LargeFileView::openFile(const QString &path) {
+  closeFile();
+  file.setFileName(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << "Large file view: cannot open" << path;
+    return false;
+  }
+  size = file.size();
+  if (size > 0) {
+    data = file.map(0, size);
+    if (!data) {
+      qWarning() << "Large file view: cannot map" << path << file.errorString();
+      file.close();
+      size = 0;
+      return false;
+    }
+  }
+  checkpoints = {0};
+  indexedLines = 1;
+  indexDone = false;
+  cursorLine = 0;
+  horizontalOffset = 0;
+  pendingCount = 0;
+  pendingG = false;
+  cancelRequested = false;
+  const quint64 generation = ++indexGeneration;
+  indexer = QThread::create([this, generation]() { buildIndex(generation); });
+  indexer->start();
+  updateScrollRange();
+  viewport()->update();
+  return true;
+}
+
+void LargeFileView::closeFile() {
+  stopIndexing();
+  if (data)
+    file.unmap(const_cast<uchar *>(data));
+  data = nullptr;
+  size = 0;
+  if (file.isOpen())
+    file.close();
+  checkpoints.clear();
+  indexedLines = 0;
+  indexDone = false;
+}
+
+void LargeFileView::stopIndexing() {
+  cancelRequested = true;
+  if (indexer) {
+    indexer->wait();
+    delete indexer;
+    indexer = nullptr;
+  }
+}
+
+QString LargeFileView::filePath() const { return file.fileName(); }
+qint64 LargeFileView::fileSize() const { return size; }
+int LargeFileView::lineCount() const { return indexedLines; }
+int LargeFileView::currentLine() const { return cursorLine; }
+bool LargeFileView::isIndexing() const { return !indexDone; }
+
+void LargeFileView::buildIndex(quint64 generation) {
+  const char *begin = reinterpret_cast<const char *>(data);
+  const char *end = begin + size;
+  const char *p = begin;
+  qint64 lines = 1;
+  QVector<qint64> batch;
+  do {
+    const char *batchEnd = p + qMin<qint64>(INDEX_BATCH_BYTES, end - p);
+    while (p < batchEnd) {
+      const void *newline = std::memchr(p, '\n', batchEnd - p);
+      if (!newline) {
+        p = batchEnd;
+        break;
+      }
+      p = static_cast<const char *>(newline) + 1;
+      if (lines % LINES_PER_CHECKPOINT == 0)
+        batch.append(p - begin);
+      ++lines;
+    }
+    emit indexBatchReady(generation, batch, lines, p >= end);
+    batch.clear();
+  } while (p < end && !cancelRequested);
+}
+
+void LargeFileView::handleIndexBatch(quint64 generation,
+                                     const QVector<qint64> &batch,
+                                     qint64 lines, bool done) {
+  if (!indexer || generation != indexGeneration)
+    return;
+  checkpoints += batch;
+  indexedLines = static_cast<int>(qMin<qint64>(lines, INT_MAX));
+  indexDone = done;
+  if (done) {
+    indexer->wait();
+    delete indexer;
+    indexer = nullptr;
+  }
+  updateScrollRange();
+  viewport()->update();
+  emit lineCountChanged(indexedLines);
+}
+
+qint64 LargeFileView::lineStart(int line) const {
+  const int checkpoint = line / LINES_PER_CHECKPOINT;
+  if (line < 0 || checkpoint >= checkpoints.size())
+    return -1;
+  const char *begin = reinterpret_cast<const char *>(data);
+  qint64 offset = checkpoints.at(checkpoint);
+  for (int skip = line % LINES_PER_CHECKPOINT; skip > 0; --skip) {
+    const void *newline =
+        std::memchr(begin + offset, '\n', static_cast<size_t>(size - offset));
+    if (!newline)
+      return -1;
+    offset = static_cast<const char *>(newline) - begin + 1;
+  }
+  return offset;
+}
+
+QString LargeFileView::lineText(int line) const {
+  const qint64 start = lineStart(line);
+  if (start < 0 || start >= size)
+    return QString();
+  const char *p = reinterpret_cast<const char *>(data) + start;
+  const qint64 available = qMin<qint64>(size - start, MAX_PAINTED_LINE_BYTES);
+  const void *newline = std::memchr(p, '\n', static_cast<size_t>(available));
+  qint64 length =
+      newline ? static_cast<const char *>(newline) - p : available;
+  if (length > 0 && p[length - 1] == '\r')
+    --length;
+  return QString::fromUtf8(p, static_cast<int>(length));
+}
+
+int LargeFileView::visibleRows() const {
+  return qMax(1, viewport()->height() / fontMetrics().lineSpacing());
+}
+
+int LargeFileView::gutterWidth() const {
+  int digits = 1;
+  int maxLines = qMax(1, indexedLines);
+  while (maxLines >= 10) {
+    maxLines /= 10;
+    ++digits;
+  }
+  return GUTTER_PADDING * 2 +
+         fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
+}
+
+void LargeFileView::updateScrollRange() {
+  const int rows = visibleRows();
+  verticalScrollBar()->setPageStep(rows);
+  verticalScrollBar()->setRange(0, qMax(0, indexedLines - rows));
+}
+
+void LargeFileView::goToLine(int line) {
+  const int target = qBound(0, line, qMax(0, indexedLines - 1));
+  const int previous = cursorLine;
+  cursorLine = target;
+  const int first = verticalScrollBar()->value();
+  const int rows = visibleRows();
+  if (target < first)
+    verticalScrollBar()->setValue(target);
+  else if (target >= first + rows)
+    verticalScrollBar()->setValue(target - rows + 1);
+  viewport()->update();
+  if (previous != cursorLine)
+    emit currentLineChanged(cursorLine);
+}
+
+void LargeFileView::goToTop() { goToLine(0); }
+void LargeFileView::goToCenter() { goToLine(indexedLines / 2 - 1); }
+void LargeFileView::goToBottom() { goToLine(indexedLines - 1); }
+
+void LargeFileView::scrollToLineStart() {
+  horizontalOffset = 0;
+  viewport()->update();
+}
+
+// Scrolls just far enough for the end of the current line to show.
+void LargeFileView::scrollToLineEnd() {
+  const int textWidth = viewport()->width() - gutterWidth() -
+                        GUTTER_PADDING * 2;
+  const int lineWidth =
+      fontMetrics()
+          .boundingRect(QRect(), Qt::TextSingleLine | Qt::TextExpandTabs,
+                        lineText(cursorLine))
+          .width();
+  horizontalOffset = qMax(0, lineWidth - textWidth);
+  viewport()->update();
+}
+
+// Vim's keys for moving around: [count]j and [count]k move by lines, gg
+// and G go to the first and last line or to line [count], and Home/0 and
+// End/$ scroll to the start and end of the current line.
+bool LargeFileView::handleKey(QKeyEvent *event) {
+  if (event->modifiers() & (Qt::ControlModifier | Qt::AltModifier))
+    return false;
+  switch (event->key()) {
+  case Qt::Key_Shift:
+  case Qt::Key_Meta:
+  case Qt::Key_AltGr:
+  case Qt::Key_CapsLock:
+    return false;
+  default:
+    break;
+  }
+  const QString text = event->text();
+  const QChar c = text.size() == 1 ? text.at(0) : QChar();
+  if (c.isDigit() && c.unicode() < 128 &&
+      (pendingCount > 0 || c != QLatin1Char('0')) && !pendingG) {
+    pendingCount = static_cast<int>(
+        qMin<qint64>(qint64(pendingCount) * 10 + c.digitValue(), INT_MAX));
+    return true;
+  }
+  const int count = pendingCount;
+  const bool secondG = pendingG;
+  pendingCount = 0;
+  pendingG = false;
+
+  const int rows = visibleRows();
+  switch (event->key()) {
+  case Qt::Key_J:
+  case Qt::Key_Down:
+    goToLine(cursorLine + qMax(1, count));
+    return true;
+  case Qt::Key_K:
+  case Qt::Key_Up:
+    goToLine(cursorLine - qMax(1, count));
+    return true;
+  case Qt::Key_PageDown:
+    verticalScrollBar()->setValue(verticalScrollBar()->value() + rows);
+    goToLine(cursorLine + rows);
+    return true;
+  case Qt::Key_PageUp:
+    verticalScrollBar()->setValue(verticalScrollBar()->value() - rows);
+    goToLine(cursorLine - rows);
+    return true;
+  case Qt::Key_G:
+    if (event->modifiers() & Qt::ShiftModifier) {
+      if (count > 0)
+        goToLine(count - 1);
+      else
+        goToBottom();
+    } else if (secondG) {
+      goToLine(count > 0 ? count - 1 : 0);
+    } else {
+      pendingCount = count;
+      pendingG = true;
+    }
+    return true;
+  case Qt::Key_Home:
+  case Qt::Key_0:
+    scrollToLineStart();
+    return true;
+  case Qt::Key_End:
+  case Qt::Key_Dollar:
+    scrollToLineEnd();
+    return true;
+  default:
+    return false;
+  }
+}
+
+void LargeFileView::paintEvent(QPaintEvent *event) {
+  QPainter painter(viewport());
+  const QRect dirtyRect = event->rect();
+  const int lineHeight = fontMetrics().lineSpacing();
+  const int gutter = gutterWidth();
+  const int first = verticalScrollBar()->value();
+  const int width = viewport()->width();
+
+  const QColor textColor = palette().color(QPalette::Text);
+  const QColor highlightColor = palette().color(QPalette::Highlight);
+  painter.fillRect(dirtyRect, palette().color(QPalette::Base));
+  painter.fillRect(QRect(0, dirtyRect.top(), gutter, dirtyRect.height()),
+                   palette().color(QPalette::Window));
+
+  const QRect textArea(gutter, 0, width - gutter, viewport()->height());
+  const int firstRow = dirtyRect.top() / lineHeight;
+  const int lastRow = dirtyRect.bottom() / lineHeight;
+  for (int row = firstRow; row <= lastRow; ++row) {
+    const int line = first + row;
+    if (line >= indexedLines)
+      break;
+    const int y = row * lineHeight;
+    if (line == cursorLine)
+      painter.fillRect(QRect(gutter, y, width - gutter, lineHeight),
+                       palette().color(QPalette::AlternateBase));
+    painter.setClipping(false);
+    painter.setPen(line == cursorLine ? highlightColor : textColor);
+    painter.drawText(QRect(0, y, gutter - GUTTER_PADDING, lineHeight),
+                     Qt::AlignRight | Qt::AlignVCenter,
+                     QString::number(line + 1));
+    painter.setClipRect(textArea);
+    painter.setPen(textColor);
+    painter.drawText(QRect(gutter + GUTTER_PADDING - horizontalOffset, y,
+                           width - gutter - GUTTER_PADDING + horizontalOffset,
+                           lineHeight),
+                     Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine |
+                         Qt::TextExpandTabs,
+                     lineText(line));
+  }
+}
+
+void LargeFileView::resizeEvent(QResizeEvent *event) {
+  QAbstractScrollArea::resizeEvent(event);
+  updateScrollRange();
+}
+
+void LargeFileView::mousePressEvent(QMouseEvent *event) {
+  const int row = event->pos().y() / fontMetrics().lineSpacing();
+  goToLine(verticalScrollBar()->value() + row);
+  QAbstractScrollArea::mousePressEvent(event);
+}
+
+void LargeFileView::wheelEvent(QWheelEvent *event) {
+  if (event->modifiers() & Qt::ControlModifier) {
+    emit zoomRequested(event->angleDelta().y());
+    event->accept();
+    return;
+  }
+  QAbstractScrollArea::wheelEvent(event);
+}
+
+void LargeFileView::changeEvent(QEvent *event) {
+  if (event->type() == QEvent::FontChange) {
+    updateScrollRange();
+    viewport()->update();
+  }
+  QAbstractScrollArea::changeEvent(event);
+}
+
+} // namespace Jino::Editor
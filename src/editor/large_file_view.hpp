@@ -0,0 +1,94 @@
+// src/editor/large_file_view.hpp
+#pragma once
+
+#include <QAbstractScrollArea>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+class QKeyEvent;
+class QThread;
+
+namespace Jino::Editor {
+
+// Read-only viewer for files too large to hold in a QTextDocument. The file
+// is memory-mapped and indexed with one offset checkpoint every
+// LINES_PER_CHECKPOINT lines, so any line is reachable with a table lookup
+// plus a short forward scan. Only the visible lines are decoded and painted.
+class LargeFileView : public QAbstractScrollArea {
+  Q_OBJECT
+
+public:
+  static constexpr int LINES_PER_CHECKPOINT = 64;
+
+  explicit LargeFileView(QWidget *parent = nullptr);
+  ~LargeFileView() override;
+
+  bool openFile(const QString &path);
+  QString filePath() const;
+  qint64 fileSize() const;
+
+  int lineCount() const;
+  int currentLine() const;
+  bool isIndexing() const;
+
+  void goToLine(int line);
+  void goToTop();
+  void goToCenter();
+  void goToBottom();
+  bool handleKey(QKeyEvent *event);
+
+signals:
+  void currentLineChanged(int line);
+  void lineCountChanged(int count);
+  void zoomRequested(int delta);
+
+  void indexBatchReady(quint64 generation, const QVector<qint64> &checkpoints,
+                       qint64 lines, bool done);
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+  void resizeEvent(QResizeEvent *event) override;
+  void mousePressEvent(QMouseEvent *event) override;
+  void wheelEvent(QWheelEvent *event) override;
+  void changeEvent(QEvent *event) override;
+
+private slots:
+  void handleIndexBatch(quint64 generation,
+                        const QVector<qint64> &checkpoints, qint64 lines,
+                        bool done);
+
+private:
+  void buildIndex(quint64 generation);
+  void stopIndexing();
+  void closeFile();
+  qint64 lineStart(int line) const;
+  QString lineText(int line) const;
+  int visibleRows() const;
+  int gutterWidth() const;
+  void updateScrollRange();
+  void scrollToLineStart();
+  void scrollToLineEnd();
+
+  QFile file;
+  const uchar *data = nullptr;
+  qint64 size = 0;
+  QVector<qint64> checkpoints;
+  int indexedLines = 0;
+  bool indexDone = false;
+  int cursorLine = 0;
+  // Pixels the text is scrolled left by, for lines wider than the view.
+  int horizontalOffset = 0;
+  // A count typed before G, gg, j or k, and whether a first g was typed.
+  int pendingCount = 0;
+  bool pendingG = false;
+
+  QThread *indexer = nullptr;
+  // Tags each indexing run, so batches still queued from a file that was
+  // closed are not added to the next file's index.
+  quint64 indexGeneration = 0;
+  std::atomic_bool cancelRequested{false};
+};
+
+} // namespace Jino::Editor
@@ -0,0 +1,106 @@
+#include "editor/layout_cache.hpp"
+
+#include <QAbstractTextDocumentLayout>
+#include <QElapsedTimer>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextLayout>
+#include <QTimer>
+
+namespace Jino::Editor {
+
+namespace {
+constexpr int CACHED_BLOCKS = 512;
+constexpr int REFINE_INTERVAL_MS = 10;
+constexpr int REFINE_SLICE_MS = 4;
+
+void releaseLayout(const QTextBlock &block) {
+  if (block.isValid() && block.layout()->lineCount() > 0)
+    block.layout()->clearLayout();
+}
+} // namespace
+
+// Evicting an entry releases the shaped lines of its block. Block numbers
+// shift when lines are inserted or removed, so an entry can end up naming
+// a different block; that only costs a re-layout, and the refinement pass
+// releases whatever a shifted entry left behind.
+class CachedLayout {
+public:
+  CachedLayout(QTextDocument *document, int blockNumber)
+      : document(document), blockNumber(blockNumber) {}
+  ~CachedLayout() {
+    if (document)
+      releaseLayout(document->findBlockByNumber(blockNumber));
+  }
+
+private:
+  QPointer<QTextDocument> document;
+  int blockNumber;
+};
+
+LayoutCache::LayoutCache(QTextDocument *document, QObject *parent)
+    : QObject(parent), document(document), layouts(CACHED_BLOCKS),
+      refineTimer(new QTimer(this)) {
+  refineTimer->setInterval(REFINE_INTERVAL_MS);
+  connect(refineTimer, &QTimer::timeout, this, &LayoutCache::refineSlice);
+  connect(document, &QTextDocument::contentsChange, this,
+          &LayoutCache::handleContentsChange);
+  refine(0);
+}
+
+LayoutCache::~LayoutCache() = default;
+
+void LayoutCache::touch(int firstBlock, int lastBlock) {
+  for (int number = firstBlock; number <= lastBlock; ++number) {
+    if (!layouts.object(number))
+      layouts.insert(number, new CachedLayout(document, number));
+  }
+}
+
+void LayoutCache::refine(int firstBlock, int lastBlock) {
+  if (refineTimer->isActive()) {
+    refineBlock = qMin(refineBlock, firstBlock);
+    refineEnd = qMax(refineEnd, lastBlock);
+  } else {
+    refineBlock = qMax(0, firstBlock);
+    refineEnd = lastBlock;
+    refineTimer->start();
+  }
+}
+
+void LayoutCache::handleContentsChange(int position, int charsRemoved,
+                                       int charsAdded) {
+  Q_UNUSED(charsRemoved);
+  if (!document)
+    return;
+  // Edits inside one block are re-laid out by the document layout itself;
+  // only multi-block changes fall back to the one-line estimate.
+  const int first = document->findBlock(position).blockNumber();
+  const int last = document->findBlock(position + charsAdded).blockNumber();
+  if (last > first)
+    refine(first, last);
+}
+
+void LayoutCache::refineSlice() {
+  if (!document) {
+    refineTimer->stop();
+    return;
+  }
+  QAbstractTextDocumentLayout *layout = document->documentLayout();
+  QTextBlock block = document->findBlockByNumber(refineBlock);
+  QElapsedTimer slice;
+  slice.start();
+  while (block.isValid() && refineBlock <= refineEnd &&
+         slice.elapsed() < REFINE_SLICE_MS) {
+    const bool cached = layouts.contains(block.blockNumber());
+    layout->blockBoundingRect(block);
+    if (!cached)
+      releaseLayout(block);
+    block = block.next();
+    ++refineBlock;
+  }
+  if (!block.isValid() || refineBlock > refineEnd)
+    refineTimer->stop();
+}
+
+} // namespace Jino::Editor
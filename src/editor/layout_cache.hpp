@@ -0,0 +1,49 @@
+// src/editor/layout_cache.hpp
+#pragma once
+
+#include <QCache>
+#include <QObject>
+#include <QPointer>
+
+#include <climits>
+
+class QTextDocument;
+class QTimer;
+
+namespace Jino::Editor {
+
+class CachedLayout;
+
+// Bounds the QTextLayouts a plain-text document keeps alive. The plain-text
+// layout only shapes blocks when they are painted or measured, but it never
+// lets go of them again; this cache remembers the most recently painted
+// blocks and clears the layout of any block that falls out of it.
+//
+// Blocks that were never shaped count as one line, so the scrollbar starts
+// out as an estimate; the same happens to every block after a width or font
+// change and to the blocks of a multi-line insert. An idle timer walks such
+// ranges in short slices, measures each block to record its real wrapped
+// line count and drops the layout again unless the block is cached.
+class LayoutCache : public QObject {
+  Q_OBJECT
+
+public:
+  explicit LayoutCache(QTextDocument *document, QObject *parent = nullptr);
+  ~LayoutCache() override;
+
+  void touch(int firstBlock, int lastBlock);
+  void refine(int firstBlock, int lastBlock = INT_MAX);
+
+private slots:
+  void handleContentsChange(int position, int charsRemoved, int charsAdded);
+  void refineSlice();
+
+private:
+  QPointer<QTextDocument> document;
+  QCache<int, CachedLayout> layouts;
+  QTimer *refineTimer;
+  int refineBlock = 0;
+  int refineEnd = -1;
+};
+
+} // namespace Jino::Editor
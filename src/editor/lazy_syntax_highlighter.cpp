@@ -0,0 +1,584 @@
+#include "editor/lazy_syntax_highlighter.hpp"
+#include "editor/format_palette.hpp"
+#include "editor/highlight_cache.hpp"
+#include "editor/highlight_profiler.hpp"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <QTextDocument>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <functional>
+
+namespace Jino::Editor {
+
+// One block's share of a job. The text is only there for the worker, which
+// replaces it with the state and the flattened token spans.
+struct TokenizedBlock {
+  int revision;
+  int length;
+  QString text;
+  int incomingState = -1;
+  int outgoingState = -1;
+  QVector<TokenSpan> spans;
+};
+
+// A run of consecutive blocks tokenized in one go, chaining the state from
+// block to block. Only the worker touches the blocks until it is done;
+// firstBlock and stale belong to the GUI thread.
+struct TokenizeJob {
+  int firstBlock = 0;
+  int incomingState = -1;
+  bool stale = false;
+  QVector<TokenizedBlock> blocks;
+
+  int lastBlock() const { return firstBlock + blocks.size() - 1; }
+};
+
+namespace {
+constexpr int IDLE_INTERVAL_MS = 10;
+constexpr int IDLE_SLICE_MS = 4;
+constexpr int WORKER_THREADS = 2;
+constexpr int MAIN_JOB_BLOCKS = 1024;
+constexpr int MAIN_JOB_CHARS = 256 * 1024;
+// After an edit the job covers the changed blocks plus this many more, in
+// which the state usually settles again.
+constexpr int SETTLE_LOOKAHEAD_BLOCKS = 64;
+// Changes spanning more blocks than this (loads, large pastes) drop what
+// was known below them instead of re-checking it block by block.
+constexpr int LARGE_CHANGE_BLOCKS = 256;
+// Blocks this far around the viewport get their formats as the frontier
+// passes them; further out only the state is recorded.
+constexpr int FORMAT_MARGIN_BLOCKS = 100;
+
+// The block's user state holds the outgoing lexer state and, in the lowest
+// bit, whether the block still shows formats from before that state was
+// settled. An unset user state (-1) reads as state -1.
+int blockState(const QTextBlock &block) {
+  const int value = block.userState();
+  return value < 0 ? -1 : (value >> 1) - 1;
+}
+
+bool formatsPending(const QTextBlock &block) {
+  const int value = block.userState();
+  return value >= 0 && (value & 1);
+}
+
+void setBlockState(QTextBlock &block, int state, bool pendingFormats) {
+  block.setUserState(((state + 1) << 1) | (pendingFormats ? 1 : 0));
+}
+
+// Paints the possibly overlapping spans of a tokenizer over the block, a
+// later span winning, and returns the visible runs.
+void flattenSpans(int length, const QVector<TokenSpan> &spans,
+                  QVector<int> &painted, QVector<TokenSpan> &runs) {
+  painted.fill(-1, length);
+  for (const TokenSpan &span : spans) {
+    const int start = qBound(0, span.start, length);
+    const int end = qBound(start, span.start + span.length, length);
+    for (int i = start; i < end; ++i)
+      painted[i] = span.token;
+  }
+  runs.clear();
+  for (int i = 0; i < length;) {
+    const int token = painted.at(i);
+    int end = i + 1;
+    while (end < length && painted.at(end) == token)
+      ++end;
+    if (token >= 0)
+      runs.append({i, end - i, token});
+    i = end;
+  }
+}
+
+class TokenizeTask : public QRunnable {
+public:
+  TokenizeTask(const QString &syntax, const BlockTokenizer *tokenizer,
+               std::shared_ptr<TokenizeJob> job, std::function<void()> done)
+      : syntax(syntax), tokenizer(tokenizer), job(std::move(job)),
+        done(std::move(done)) {}
+
+  void run() override {
+    HighlightCache &cache = HighlightCache::instance();
+    QVector<TokenSpan> spans;
+    QVector<int> painted;
+    int state = job->incomingState;
+    for (TokenizedBlock &block : job->blocks) {
+      block.incomingState = state;
+      const HighlightCache::Key key =
+          HighlightCache::keyFor(syntax, block.text, state);
+      if (!cache.lookup(key, block.text, state, block.spans)) {
+        spans.clear();
+        state = tokenizer->tokenize(block.text, state, spans);
+        flattenSpans(block.text.size(), spans, painted, block.spans);
+        cache.insert(key, block.text, state, block.spans);
+      }
+      block.outgoingState = state;
+      block.text = QString();
+    }
+    done();
+  }
+
+private:
+  QString syntax;
+  const BlockTokenizer *tokenizer;
+  std::shared_ptr<TokenizeJob> job;
+  std::function<void()> done;
+};
+} // namespace
+
+LazySyntaxHighlighter::LazySyntaxHighlighter(
+    QTextDocument *document, const QString &syntax,
+    std::unique_ptr<BlockTokenizer> tokenizer)
+    : QObject(document), textDocument(document), syntax(syntax),
+      tokenizer(std::move(tokenizer)), pool(new QThreadPool(this)),
+      idleTimer(new QTimer(this)) {
+  pool->setMaxThreadCount(WORKER_THREADS);
+  idleTimer->setInterval(IDLE_INTERVAL_MS);
+  connect(idleTimer, &QTimer::timeout, this,
+          &LazySyntaxHighlighter::processIdleSlice);
+  connect(document, &QTextDocument::contentsChange, this,
+          &LazySyntaxHighlighter::handleContentsChange);
+  connect(&FormatPalette::instance(), &FormatPalette::formatsChanged, this,
+          &LazySyntaxHighlighter::handlePaletteChange);
+  rehighlight();
+}
+
+// Leaves no formats or states behind, like QSyntaxHighlighter does when it
+// is detached from its document.
+LazySyntaxHighlighter::~LazySyntaxHighlighter() {
+  pool->waitForDone();
+  if (!textDocument)
+    return;
+  applying = true;
+  for (QTextBlock block = textDocument->begin(); block.isValid();
+       block = block.next()) {
+    block.setUserState(-1);
+    QTextLayout *layout = block.layout();
+    if (layout->formats().isEmpty())
+      continue;
+    const bool laidOut = layout->lineCount() > 0;
+    layout->clearFormats();
+    textDocument->markContentsDirty(block.position(), block.length());
+    if (!laidOut)
+      layout->clearLayout();
+  }
+}
+
+QTextDocument *LazySyntaxHighlighter::document() const {
+  return textDocument;
+}
+
+void LazySyntaxHighlighter::rehighlight() {
+  frontier = 0;
+  cleanFrom = 0;
+  settledEnd = 0;
+  provisional.clear();
+  knownBlockCount = textDocument ? textDocument->blockCount() : 0;
+  if (mainJob) {
+    mainJob->stale = true;
+    if (mainJobDone)
+      mainJob.reset();
+  }
+  if (viewportJob)
+    viewportJob->stale = true;
+  submitMainJob();
+}
+
+// Makes sure the given blocks, typically the ones in the viewport, are
+// highlighted or on their way without waiting for the frontier: blocks
+// beyond it are tokenized with a guessed incoming state, blocks behind it
+// whose formats were deferred get them now.
+void LazySyntaxHighlighter::highlightBlocks(int firstBlock, int lastBlock) {
+  if (!textDocument)
+    return;
+  visibleFirst = firstBlock;
+  visibleLast = lastBlock;
+  int known = settledEnd;
+  if (mainJob && !mainJob->stale)
+    known = qMax(known, mainJob->lastBlock() + 1);
+  int number = qMax(firstBlock, 0);
+  QTextBlock block = textDocument->findBlockByNumber(number);
+  for (; block.isValid() && number <= lastBlock;
+       block = block.next(), ++number) {
+    if (number < frontier) {
+      if (formatsPending(block))
+        break;
+      continue;
+    }
+    if (number < known)
+      continue;
+    const auto guess = provisional.constFind(number);
+    if (guess == provisional.constEnd() ||
+        guess.value() != blockState(block.previous()))
+      break;
+  }
+  if (!block.isValid() || number > lastBlock)
+    return;
+  if (viewportJob) {
+    viewportRequestFirst = firstBlock;
+    viewportRequestLast = lastBlock;
+    return;
+  }
+  submitViewportJob(block, lastBlock);
+}
+
+bool LazySyntaxHighlighter::isComplete() const {
+  return !textDocument || frontier >= textDocument->blockCount();
+}
+
+LazySyntaxHighlighter::CascadeStats
+LazySyntaxHighlighter::lastCascade() const {
+  return finishedCascade;
+}
+
+void LazySyntaxHighlighter::setTokenFormat(int token,
+                                           const QTextCharFormat &format) {
+  if (token >= tokenFormats.size())
+    tokenFormats.resize(token + 1, -1);
+  tokenFormats[token] = FormatPalette::instance().intern(format);
+}
+
+// Token spans are cached, so going over the document again only costs the
+// cache lookups; blocks away from the view keep the old format until they
+// are scrolled to, as with any other deferred change.
+void LazySyntaxHighlighter::handlePaletteChange(const QVector<int> &ids) {
+  for (const int id : ids) {
+    if (tokenFormats.contains(id)) {
+      rehighlight();
+      return;
+    }
+  }
+}
+
+void LazySyntaxHighlighter::handleContentsChange(int position,
+                                                 int charsRemoved,
+                                                 int charsAdded) {
+  if (applying || !textDocument)
+    return;
+  const int blockCount = textDocument->blockCount();
+  const int delta = blockCount - knownBlockCount;
+  knownBlockCount = blockCount;
+
+  const QTextBlock first = textDocument->findBlock(position);
+  const QTextBlock last = textDocument->findBlock(position + charsAdded);
+  const int firstNumber = first.isValid() ? first.blockNumber() : 0;
+  const int lastNumber = last.isValid() ? last.blockNumber() : blockCount - 1;
+
+  for (const auto &job : {mainJob, viewportJob}) {
+    if (job && firstNumber <= job->lastBlock())
+      job->stale = true;
+  }
+  // Guesses recorded past the change may now belong to other blocks.
+  for (auto it = provisional.begin(); it != provisional.end();) {
+    if (it.key() >= firstNumber)
+      it = provisional.erase(it);
+    else
+      ++it;
+  }
+  // Until the worker has been through it, an edited line keeps its old
+  // formats moved along with the text.
+  if (first.isValid() && firstNumber == lastNumber && delta == 0)
+    shiftFormats(first, position - first.position(), charsRemoved,
+                 charsAdded);
+
+  if (firstNumber < settledEnd) {
+    startCascade(lastNumber);
+    const auto shift = [&](int block) {
+      return block <= firstNumber ? block : qMax(lastNumber + 1, block + delta);
+    };
+    if (lastNumber - firstNumber > LARGE_CHANGE_BLOCKS) {
+      frontier = qMin(frontier, firstNumber);
+      cleanFrom = qMin(shift(cleanFrom), firstNumber);
+      settledEnd = firstNumber;
+    } else {
+      cleanFrom = frontier < cleanFrom
+                      ? qMax(shift(cleanFrom), lastNumber + 1)
+                      : lastNumber + 1;
+      frontier = qMin(frontier, firstNumber);
+      settledEnd = qMax(shift(settledEnd), cleanFrom);
+    }
+  }
+
+  if (mainJob && mainJob->stale && mainJobDone) {
+    idleTimer->stop();
+    mainJob.reset();
+  }
+  submitMainJob();
+}
+
+// Applies the results of the main job from the frontier on. Applying stops
+// at the first block that was edited or whose incoming state changed since
+// the job was submitted, and as soon as the state flowing into the clean
+// region is the one it was highlighted with.
+void LazySyntaxHighlighter::processIdleSlice() {
+  if (!textDocument || !mainJob || !mainJobDone) {
+    idleTimer->stop();
+    return;
+  }
+  const TokenizeJob &job = *mainJob;
+  bool finished =
+      job.stale || job.firstBlock + appliedFromMainJob != frontier;
+  QTextBlock block = textDocument->findBlockByNumber(frontier);
+  QElapsedTimer slice;
+  slice.start();
+  while (!finished && slice.elapsed() < IDLE_SLICE_MS) {
+    if (appliedFromMainJob == job.blocks.size() ||
+        !isCurrent(block, appliedFromMainJob, job)) {
+      finished = true;
+      break;
+    }
+    const TokenizedBlock &result = job.blocks.at(appliedFromMainJob++);
+    const int previousOutgoing = blockState(block);
+    const bool nearView = frontier >= visibleFirst - FORMAT_MARGIN_BLOCKS &&
+                          frontier <= visibleLast + FORMAT_MARGIN_BLOCKS;
+    buildRanges(result.spans);
+    const bool deferred = !nearView && !formatsInstalled(block);
+    if (nearView)
+      installFormats(block);
+    setBlockState(block, result.outgoingState, deferred);
+    provisional.remove(frontier);
+    if (cascadeActive && frontier > cascadeEditEnd) {
+      ++cascadeStats.blocks;
+      if (deferred)
+        ++cascadeStats.deferred;
+    }
+    ++frontier;
+    if (frontier >= cleanFrom && frontier < settledEnd &&
+        result.outgoingState == previousOutgoing) {
+      frontier = settledEnd;
+      finished = true;
+    }
+    cleanFrom = qMax(cleanFrom, frontier);
+    settledEnd = qMax(settledEnd, frontier);
+    block = block.next();
+  }
+  if (cascadeActive && frontier >= settledEnd)
+    finishCascade();
+  if (!finished) {
+    scheduleIdle();
+    return;
+  }
+  idleTimer->stop();
+  mainJob.reset();
+  submitMainJob();
+}
+
+std::shared_ptr<TokenizeJob>
+LazySyntaxHighlighter::createJob(const QTextBlock &first,
+                                 int maxBlocks) const {
+  auto job = std::make_shared<TokenizeJob>();
+  job->firstBlock = first.blockNumber();
+  job->incomingState = blockState(first.previous());
+  int chars = 0;
+  for (QTextBlock block = first; block.isValid(); block = block.next()) {
+    if (job->blocks.size() == maxBlocks ||
+        (!job->blocks.isEmpty() && chars >= MAIN_JOB_CHARS))
+      break;
+    TokenizedBlock input;
+    input.revision = block.revision();
+    input.length = block.length();
+    input.text = block.text();
+    chars += input.length;
+    job->blocks.append(input);
+  }
+  return job;
+}
+
+void LazySyntaxHighlighter::submitMainJob() {
+  if (mainJob || !textDocument || frontier >= textDocument->blockCount())
+    return;
+  const int maxBlocks =
+      frontier < cleanFrom
+          ? qMin(cleanFrom - frontier + SETTLE_LOOKAHEAD_BLOCKS,
+                 MAIN_JOB_BLOCKS)
+          : MAIN_JOB_BLOCKS;
+  const auto job =
+      createJob(textDocument->findBlockByNumber(frontier), maxBlocks);
+  mainJob = job;
+  mainJobDone = false;
+  appliedFromMainJob = 0;
+  startJob(job);
+}
+
+void LazySyntaxHighlighter::submitViewportJob(const QTextBlock &first,
+                                              int lastBlock) {
+  const auto job = createJob(first, lastBlock - first.blockNumber() + 1);
+  viewportJob = job;
+  startJob(job);
+}
+
+// The pool is waited for on destruction, so the completion can safely be
+// queued back to this object.
+void LazySyntaxHighlighter::startJob(const std::shared_ptr<TokenizeJob> &job) {
+  pool->start(new TokenizeTask(syntax, tokenizer.get(), job, [this, job]() {
+    QMetaObject::invokeMethod(
+        this, [this, job]() { handleJobDone(job); }, Qt::QueuedConnection);
+  }));
+}
+
+void LazySyntaxHighlighter::handleJobDone(
+    const std::shared_ptr<TokenizeJob> &job) {
+  if (job == mainJob) {
+    mainJobDone = true;
+    processIdleSlice();
+    return;
+  }
+  if (job != viewportJob)
+    return;
+  viewportJob.reset();
+  if (!job->stale)
+    applyViewportJob(*job);
+  if (viewportRequestFirst >= 0) {
+    const int firstBlock = viewportRequestFirst;
+    const int lastBlock = viewportRequestLast;
+    viewportRequestFirst = viewportRequestLast = -1;
+    highlightBlocks(firstBlock, lastBlock);
+  }
+}
+
+// Viewport results give blocks behind the frontier their deferred formats
+// and highlight blocks beyond what the frontier has settled, recording the
+// incoming state each was computed with.
+void LazySyntaxHighlighter::applyViewportJob(const TokenizeJob &job) {
+  QTextBlock block = textDocument->findBlockByNumber(job.firstBlock);
+  int number = job.firstBlock;
+  for (int i = 0; i < job.blocks.size() && block.isValid();
+       ++i, ++number, block = block.next()) {
+    if (!isCurrent(block, i, job))
+      continue;
+    const TokenizedBlock &result = job.blocks.at(i);
+    if (number < frontier) {
+      if (formatsPending(block) && result.outgoingState == blockState(block)) {
+        applyFormats(block, result.spans);
+        setBlockState(block, result.outgoingState, false);
+      }
+      continue;
+    }
+    if (number < settledEnd)
+      continue;
+    applyFormats(block, result.spans);
+    setBlockState(block, result.outgoingState, false);
+    provisional.insert(number, result.incomingState);
+  }
+}
+
+bool LazySyntaxHighlighter::isCurrent(const QTextBlock &block, int index,
+                                      const TokenizeJob &job) const {
+  const TokenizedBlock &result = job.blocks.at(index);
+  return block.isValid() && block.revision() == result.revision &&
+         block.length() == result.length &&
+         blockState(block.previous()) == result.incomingState;
+}
+
+// Moves the block's formats along with an edit inside it: ranges after the
+// edit shift, a range spanning it grows or shrinks, removed text takes its
+// formatting with it.
+void LazySyntaxHighlighter::shiftFormats(const QTextBlock &block, int offset,
+                                         int removed, int added) {
+  const QVector<QTextLayout::FormatRange> formats = block.layout()->formats();
+  if (formats.isEmpty())
+    return;
+  const auto map = [&](int position) {
+    if (position <= offset)
+      return position;
+    if (position >= offset + removed)
+      return position + added - removed;
+    return offset;
+  };
+  ranges.clear();
+  for (const QTextLayout::FormatRange &range : formats) {
+    QTextLayout::FormatRange shifted = range;
+    shifted.start = map(range.start);
+    shifted.length = map(range.start + range.length) - shifted.start;
+    if (shifted.length > 0)
+      ranges.append(shifted);
+  }
+  installFormats(block);
+}
+
+void LazySyntaxHighlighter::applyFormats(const QTextBlock &block,
+                                         const QVector<TokenSpan> &spans) {
+  buildRanges(spans);
+  installFormats(block);
+}
+
+void LazySyntaxHighlighter::buildRanges(const QVector<TokenSpan> &spans) {
+  const FormatPalette &palette = FormatPalette::instance();
+  ranges.clear();
+  for (const TokenSpan &span : spans) {
+    const int id = tokenFormats.value(span.token, -1);
+    if (id < 0)
+      continue;
+    QTextLayout::FormatRange range;
+    range.start = span.start;
+    range.length = span.length;
+    range.format = palette.format(id);
+    ranges.append(range);
+  }
+}
+
+// Whether the block already shows the ranges just built, compared by
+// palette key rather than format properties.
+bool LazySyntaxHighlighter::formatsInstalled(const QTextBlock &block) const {
+  const QVector<QTextLayout::FormatRange> installed = block.layout()->formats();
+  if (installed.size() != ranges.size())
+    return false;
+  for (int i = 0; i < ranges.size(); ++i) {
+    const QTextLayout::FormatRange &a = installed.at(i);
+    const QTextLayout::FormatRange &b = ranges.at(i);
+    if (a.start != b.start || a.length != b.length ||
+        !FormatPalette::sameFormat(a.format, b.format))
+      return false;
+  }
+  return true;
+}
+
+void LazySyntaxHighlighter::installFormats(const QTextBlock &block) {
+  QTextLayout *layout = block.layout();
+  if (formatsInstalled(block))
+    return;
+  // Applying formats re-lays the block out; blocks that were not shaped
+  // before are released again so background results do not undo the
+  // viewport-only layout.
+  const bool laidOut = layout->lineCount() > 0;
+  layout->setFormats(ranges);
+  applying = true;
+  textDocument->markContentsDirty(block.position(), block.length());
+  applying = false;
+  if (!laidOut)
+    layout->clearLayout();
+}
+
+// A cascade is measured from an edit that reaches into settled blocks until
+// the state flowing out of the edit matches what follows again: blocks
+// highlighted after the edited range, how many of them were left with
+// deferred formats, and the time it took.
+void LazySyntaxHighlighter::startCascade(int editEnd) {
+  if (cascadeActive)
+    finishCascade();
+  cascadeActive = true;
+  cascadeStats = CascadeStats();
+  cascadeTimer.start();
+  cascadeEditEnd = editEnd;
+}
+
+void LazySyntaxHighlighter::finishCascade() {
+  cascadeActive = false;
+  cascadeStats.elapsedMs = cascadeTimer.elapsed();
+  finishedCascade = cascadeStats;
+  if (HighlightProfiler::enabled() && finishedCascade.blocks > 0)
+    qInfo().nospace() << "Highlight cascade: " << finishedCascade.blocks
+                      << " blocks after the edit, "
+                      << finishedCascade.deferred << " formats deferred, "
+                      << finishedCascade.elapsedMs << " ms";
+}
+
+void LazySyntaxHighlighter::scheduleIdle() {
+  if (!idleTimer->isActive())
+    idleTimer->start();
+}
+
+} // namespace Jino::Editor
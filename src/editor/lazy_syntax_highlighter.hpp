@@ -0,0 +1,135 @@
+// src/editor/lazy_syntax_highlighter.hpp
+#pragma once
+
+#include "editor/block_tokenizer.hpp"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTextBlock>
+#include <QTextCharFormat>
+#include <QTextLayout>
+#include <QVector>
+
+#include <memory>
+
+class QTextDocument;
+class QThreadPool;
+class QTimer;
+
+namespace Jino::Editor {
+
+struct TokenizeJob;
+
+// Base class for the editor's highlighters, used instead of
+// QSyntaxHighlighter. Subclasses hand over a BlockTokenizer and the format
+// for each of its tokens, which is interned in the shared FormatPalette.
+// Tokenizing runs on worker threads over copies of the block text and only
+// installing the resulting format ranges happens on the GUI thread, so the
+// cost of the rules never shows up in typing latency. When palette entries
+// the highlighter uses are replaced, as on a theme change, it highlights
+// the document again from the cached spans.
+//
+// Blocks are highlighted in document order from a frontier: everything
+// above it has been highlighted with its real incoming state. Batches of
+// blocks from the frontier go to a worker and their results are applied in
+// short idle slices. Blocks the editor shows beyond the frontier are
+// tokenized straight away with the state their previous block currently
+// holds and redone if that guess turns out wrong. Every result carries the
+// revision of the block it was computed from; results for blocks edited in
+// the meantime are dropped and the blocks resubmitted. Workers consult the
+// shared HighlightCache before running the tokenizer.
+//
+// Away from the viewport the frontier only records block states. Blocks
+// whose formats changed there keep their old ones until they are scrolled
+// into view, so a state change running down a long document (an opening
+// code fence) does not re-lay out every block below it.
+class LazySyntaxHighlighter : public QObject {
+  Q_OBJECT
+
+public:
+  struct CascadeStats {
+    int blocks = 0;
+    int deferred = 0;
+    qint64 elapsedMs = 0;
+  };
+
+  LazySyntaxHighlighter(QTextDocument *document, const QString &syntax,
+                        std::unique_ptr<BlockTokenizer> tokenizer);
+  ~LazySyntaxHighlighter() override;
+
+  QTextDocument *document() const;
+
+  void rehighlight();
+  void highlightBlocks(int firstBlock, int lastBlock);
+  bool isComplete() const;
+  CascadeStats lastCascade() const;
+
+protected:
+  void setTokenFormat(int token, const QTextCharFormat &format);
+
+private slots:
+  void handleContentsChange(int position, int charsRemoved, int charsAdded);
+  void handlePaletteChange(const QVector<int> &ids);
+  void processIdleSlice();
+
+private:
+  std::shared_ptr<TokenizeJob> createJob(const QTextBlock &first,
+                                         int maxBlocks) const;
+  void submitMainJob();
+  void submitViewportJob(const QTextBlock &first, int lastBlock);
+  void startJob(const std::shared_ptr<TokenizeJob> &job);
+  void handleJobDone(const std::shared_ptr<TokenizeJob> &job);
+  void applyViewportJob(const TokenizeJob &job);
+  bool isCurrent(const QTextBlock &block, int index,
+                 const TokenizeJob &job) const;
+  void shiftFormats(const QTextBlock &block, int offset, int removed,
+                    int added);
+  void applyFormats(const QTextBlock &block, const QVector<TokenSpan> &spans);
+  void buildRanges(const QVector<TokenSpan> &spans);
+  bool formatsInstalled(const QTextBlock &block) const;
+  void installFormats(const QTextBlock &block);
+  void startCascade(int editEnd);
+  void finishCascade();
+  void scheduleIdle();
+
+  QPointer<QTextDocument> textDocument;
+  QString syntax;
+  std::unique_ptr<BlockTokenizer> tokenizer;
+  // Palette ids by token, -1 for tokens left unformatted.
+  QVector<int> tokenFormats;
+  QThreadPool *pool;
+  QTimer *idleTimer;
+
+  // Blocks [frontier, cleanFrom) need tokenizing again, blocks
+  // [cleanFrom, settledEnd) are highlighted and stay valid as long as the
+  // state flowing into them is unchanged, the rest has not been reached.
+  int frontier = 0;
+  int cleanFrom = 0;
+  int settledEnd = 0;
+  int knownBlockCount = 0;
+  QHash<int, int> provisional;
+  bool applying = false;
+  int visibleFirst = 0;
+  int visibleLast = -1;
+
+  bool cascadeActive = false;
+  int cascadeEditEnd = -1;
+  CascadeStats cascadeStats;
+  CascadeStats finishedCascade;
+  QElapsedTimer cascadeTimer;
+
+  std::shared_ptr<TokenizeJob> mainJob;
+  std::shared_ptr<TokenizeJob> viewportJob;
+  int appliedFromMainJob = 0;
+  bool mainJobDone = false;
+  bool viewportJobDone = false;
+  int viewportRequestFirst = -1;
+  int viewportRequestLast = -1;
+
+  QVector<QTextLayout::FormatRange> ranges;
+};
+
+} // namespace Jino::Editor
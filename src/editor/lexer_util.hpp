@@ -0,0 +1,58 @@
+// src/editor/lexer_util.hpp
+#pragma once
+
+#include <QLatin1String>
+#include <QString>
+#include <QStringRef>
+
+namespace Jino::Editor::Lexer {
+
+// Memoised forward search for a closing delimiter. Where a closer may sit
+// does not depend on where its opener was, so every opener before the last
+// hit shares it, and a failed search settles all later openers as well.
+// This keeps the inline sweeps of the highlighters linear in the line
+// length.
+struct NextToken {
+  int from = -1;
+  int at = -1;
+
+  bool covers(int position) const {
+    return from >= 0 && from <= position && (at < 0 || at >= position);
+  }
+};
+
+template <typename Predicate>
+int findNext(const QString &text, int from, NextToken &memo,
+             Predicate isCloser) {
+  if (!memo.covers(from)) {
+    memo.from = from;
+    memo.at = -1;
+    for (int i = from; i < text.size(); ++i) {
+      if (isCloser(i)) {
+        memo.at = i;
+        break;
+      }
+    }
+  }
+  return memo.at;
+}
+
+inline int findToken(const QString &text, QLatin1String token, int from,
+                     NextToken &memo) {
+  if (!memo.covers(from)) {
+    memo.from = from;
+    memo.at = text.indexOf(token, from);
+  }
+  return memo.at;
+}
+
+inline bool hasTokenAt(const QString &text, int position,
+                       QLatin1String token) {
+  return text.midRef(position, token.size()) == token;
+}
+
+inline bool isWordChar(QChar c) {
+  return c.isLetterOrNumber() || c == QLatin1Char('_');
+}
+
+} // namespace Jino::Editor::Lexer
@@ -3,10 +3,12 @@
 
 #include <QAbstractTextDocumentLayout>
 #include <QDebug>
+#include <QEvent>
 #include <QPainter>
 #include <QPalette>
-#include <QScrollBar>
 #include <QTextBlock>
+#include <QTextDocument>
+#include <QTransform>
 
 LineNumberWidget::LineNumberWidget(EditorWidget *editor)
     : QWidget(editor), codeEditor(editor) {
@@ -32,43 +34,55 @@ QSize LineNumberWidget::sizeHint() const {
 void LineNumberWidget::paintEvent(QPaintEvent *event) {
   QPainter painter(this);
 
+  const QRect dirtyRect = event->rect();
   const int currentLine = codeEditor->textCursor().blockNumber();
-  const QFontMetrics editorFontMetrics = codeEditor->fontMetrics();
-  const int fontHeight = editorFontMetrics.height();
   const int widgetWidth = this->width();
-  const int editorScrollY = codeEditor->verticalScrollBar()->value();
-
-  QTextBlock block = codeEditor->document()->firstBlock();
-  int blockNumber = block.blockNumber();
+  QAbstractTextDocumentLayout *layout =
+      codeEditor->document()->documentLayout();
 
   QColor defaultColor = palette().color(QPalette::Text);
   QColor highlightColor = palette().color(QPalette::Highlight);
 
-  while (block.isValid()) {
-    QRectF blockRect =
-        codeEditor->document()->documentLayout()->blockBoundingRect(block);
-    qreal blockViewportTop = blockRect.top() - editorScrollY;
-    qreal blockViewportBottom = blockViewportTop + blockRect.height();
-
-    if (blockViewportTop < event->rect().bottom() &&
-        blockViewportBottom > event->rect().top()) {
-      const QString number = QString::number(blockNumber + 1);
-
-      const QColor textColor =
-          (blockNumber == currentLine) ? highlightColor : defaultColor;
-      painter.setPen(textColor);
-
-      painter.drawText(0, qRound(blockViewportTop), widgetWidth - 3, fontHeight,
-                       Qt::AlignRight, number);
-    }
+  // Only blocks from the first visible one down are laid out, so walk
+  // forward from there instead of searching the whole document.
+  QTextBlock block = codeEditor->firstVisibleTextBlock();
+  int blockNumber = block.blockNumber();
+  qreal blockViewportTop = codeEditor->blockViewportTop(block);
 
-    if (blockViewportTop > event->rect().bottom()) {
-      break;
+  while (block.isValid() && blockViewportTop <= dirtyRect.bottom()) {
+    const qreal blockHeight = layout->blockBoundingRect(block).height();
+    if (block.isVisible() &&
+        blockViewportTop + blockHeight > dirtyRect.top()) {
+      const QStaticText &number = staticNumber(blockNumber + 1);
+      painter.setPen(blockNumber == currentLine ? highlightColor
+                                                : defaultColor);
+      painter.drawStaticText(
+          QPointF(widgetWidth - 3 - number.size().width(),
+                  qRound(blockViewportTop)),
+          number);
     }
 
+    blockViewportTop += blockHeight;
     block = block.next();
-    if (!block.isValid())
-      break;
-    blockNumber = block.blockNumber();
+    ++blockNumber;
   }
 }
+
+void LineNumberWidget::changeEvent(QEvent *event) {
+  if (event->type() == QEvent::FontChange)
+    numberCache.clear();
+  QWidget::changeEvent(event);
+}
+
+const QStaticText &LineNumberWidget::staticNumber(int number) {
+  constexpr int maxCachedNumbers = 2048;
+  auto cached = numberCache.constFind(number);
+  if (cached != numberCache.constEnd())
+    return cached.value();
+  if (numberCache.size() >= maxCachedNumbers)
+    numberCache.clear();
+  QStaticText text(QString::number(number));
+  text.setTextFormat(Qt::PlainText);
+  text.prepare(QTransform(), font());
+  return numberCache.insert(number, text).value();
+}
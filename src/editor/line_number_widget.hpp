@@ -1,9 +1,12 @@
 #pragma once
 
+#include <QHash>
 #include <QPaintEvent>
+#include <QStaticText>
 #include <QWidget>
 
 class EditorWidget;
+class QEvent;
 
 class LineNumberWidget : public QWidget {
   Q_OBJECT
@@ -15,7 +18,11 @@ public:
 
 protected:
   void paintEvent(QPaintEvent *event) override;
+  void changeEvent(QEvent *event) override;
 
 private:
+  const QStaticText &staticNumber(int number);
+
   EditorWidget *codeEditor;
+  QHash<int, QStaticText> numberCache;
 };
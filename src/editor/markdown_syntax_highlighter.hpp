@@ -1,44 +1,19 @@
 // src/editor/markdown_syntax_highlighter.hpp
 #pragma once
 
-#include <QRegularExpression>
-#include <QSyntaxHighlighter>
-#include <QTextCharFormat>
+#include "editor/lazy_syntax_highlighter.hpp"
 
 class QTextDocument;
 
 namespace Jino::Editor {
 
-class MarkdownSyntaxHighlighter : public QSyntaxHighlighter {
+// Markdown highlighting: MarkdownTokenizer on the worker side, the colours
+// for its tokens here.
+class MarkdownSyntaxHighlighter : public LazySyntaxHighlighter {
   Q_OBJECT
 
 public:
-  explicit MarkdownSyntaxHighlighter(QTextDocument *parent = nullptr);
-
-protected:
-  void highlightBlock(const QString &text) override;
-
-private:
-  struct HighlightingRule {
-    QRegularExpression pattern;
-    QTextCharFormat format;
-    int captureGroup = 0;
-  };
-  QVector<HighlightingRule> highlightingRules;
-
-  QTextCharFormat headingFormat;
-  QTextCharFormat boldFormat;
-  QTextCharFormat italicFormat;
-  QTextCharFormat boldItalicFormat;
-  QTextCharFormat strikethroughFormat;
-  QTextCharFormat inlineCodeFormat;
-  QTextCharFormat linkFormat;
-  QTextCharFormat imageFormat;
-  QTextCharFormat blockQuoteFormat;
-
-  QRegularExpression codeBlockStartExpression;
-  QRegularExpression codeBlockEndExpression;
-  QTextCharFormat codeBlockFormat;
+  explicit MarkdownSyntaxHighlighter(QTextDocument *parent);
 };
 
 } // namespace Jino::Editor
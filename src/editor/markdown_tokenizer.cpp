@@ -0,0 +1,152 @@
+#include "editor/markdown_tokenizer.hpp"
+#include "editor/lexer_util.hpp"
+
+namespace Jino::Editor {
+
+using Lexer::findNext;
+using Lexer::findToken;
+using Lexer::hasTokenAt;
+using Lexer::NextToken;
+
+namespace {
+constexpr int FENCE_LENGTH = 3;
+constexpr int IN_FENCE_STATE = 1;
+
+bool startsWithFence(const QString &text) {
+  return text.startsWith(QLatin1String("```")) ||
+         text.startsWith(QLatin1String("~~~"));
+}
+
+bool isEmphasisMarker(QChar c) {
+  return c == QLatin1Char('*') || c == QLatin1Char('_');
+}
+
+// A closing emphasis marker is not preceded by whitespace and not followed
+// by another marker.
+int findItalicCloser(const QString &text, QChar marker, int from,
+                     NextToken &memo) {
+  return findNext(text, from, memo, [&](int j) {
+    return text.at(j) == marker && !text.at(j - 1).isSpace() &&
+           (j + 1 == text.size() || !isEmphasisMarker(text.at(j + 1)));
+  });
+}
+} // namespace
+
+MarkdownTokenizer::MarkdownTokenizer() : profiler("Markdown") {}
+
+int MarkdownTokenizer::tokenize(const QString &text, int previousState,
+                                QVector<TokenSpan> &spans) const {
+  HighlightProfiler::Scope timing(profiler, text.size());
+  int fenceEnd = 0;
+
+  // Fences only count at the start of a line. The rest of an opening fence
+  // line (usually the info string) belongs to the code block.
+  if (previousState == IN_FENCE_STATE) {
+    if (!startsWithFence(text)) {
+      spans.append({0, text.length(), CodeBlock});
+      return IN_FENCE_STATE;
+    }
+    fenceEnd = FENCE_LENGTH;
+    spans.append({0, fenceEnd, CodeBlock});
+  } else if (startsWithFence(text)) {
+    spans.append({0, text.length(), CodeBlock});
+    return IN_FENCE_STATE;
+  }
+
+  int hashes = 0;
+  while (hashes < text.length() && text.at(hashes) == QLatin1Char('#'))
+    ++hashes;
+  if (hashes > 0 && hashes < text.length() && text.at(hashes).isSpace())
+    spans.append({0, text.length(), Heading});
+
+  int quote = 0;
+  while (quote < text.length() && (text.at(quote) == QLatin1Char('>') ||
+                                   text.at(quote) == QLatin1Char(' ')))
+    ++quote;
+  if (quote > 0)
+    spans.append({0, quote, BlockQuote});
+
+  InlineSpans inlineSpans;
+  scanInline(text, fenceEnd, inlineSpans);
+  for (int token = Link; token < TokenCount; ++token) {
+    for (const TokenSpan &span : qAsConst(inlineSpans)) {
+      if (span.token == token)
+        spans.append(span);
+    }
+  }
+  return 0;
+}
+
+// Every rule resumes after its own previous match, the way a separate
+// global match per rule would, and closers are found through memoised
+// searches, so the sweep stays linear in the block length.
+void MarkdownTokenizer::scanInline(const QString &text, int fenceEnd,
+                                   InlineSpans &inlineSpans) const {
+  const int length = text.length();
+  int resume[TokenCount] = {};
+  NextToken linkClose, linkTarget, strikeClose, codeClose;
+  NextToken boldItalicClose[2], boldClose[2], italicClose[2];
+
+  // Matches lying inside a closing fence are part of the code block.
+  const auto addSpan = [&](Token token, int matchEnd, int start,
+                           int spanLength) {
+    resume[token] = matchEnd;
+    if (matchEnd > fenceEnd)
+      inlineSpans.append({start, spanLength, token});
+  };
+
+  for (int i = 0; i < length; ++i) {
+    const QChar c = text.at(i);
+
+    if ((c == QLatin1Char('[') || c == QLatin1Char('!')) &&
+        i >= resume[Link]) {
+      const int open = c == QLatin1Char('!') ? i + 1 : i;
+      if (open < length && text.at(open) == QLatin1Char('[')) {
+        const int close =
+            findToken(text, QLatin1String("]"), open + 1, linkClose);
+        if (close >= 0 && close + 1 < length &&
+            text.at(close + 1) == QLatin1Char('(')) {
+          const int end =
+              findToken(text, QLatin1String(")"), close + 2, linkTarget);
+          if (end >= 0)
+            addSpan(Link, end + 1, i, end + 1 - i);
+        }
+      }
+    } else if (isEmphasisMarker(c)) {
+      const int marker = c == QLatin1Char('*') ? 0 : 1;
+      const QLatin1String triple(marker == 0 ? "***" : "___");
+      const QLatin1String pair(marker == 0 ? "**" : "__");
+      if (i >= resume[BoldItalic] && hasTokenAt(text, i, triple)) {
+        const int close =
+            findToken(text, triple, i + 4, boldItalicClose[marker]);
+        if (close >= 0)
+          addSpan(BoldItalic, close + 3, i + 3, close - i - 3);
+      }
+      if (i >= resume[Bold] && hasTokenAt(text, i, pair)) {
+        const int close = findToken(text, pair, i + 3, boldClose[marker]);
+        if (close >= 0)
+          addSpan(Bold, close + 2, i + 2, close - i - 2);
+      }
+      if (i >= resume[Italic] &&
+          (i == 0 || !isEmphasisMarker(text.at(i - 1))) && i + 1 < length &&
+          !text.at(i + 1).isSpace()) {
+        const int close =
+            findItalicCloser(text, c, i + 2, italicClose[marker]);
+        if (close >= 0)
+          addSpan(Italic, close + 1, i + 1, close - i - 1);
+      }
+    } else if (c == QLatin1Char('~') && i >= resume[Strikethrough] &&
+               hasTokenAt(text, i, QLatin1String("~~"))) {
+      const int close =
+          findToken(text, QLatin1String("~~"), i + 3, strikeClose);
+      if (close >= 0)
+        addSpan(Strikethrough, close + 2, i + 2, close - i - 2);
+    } else if (c == QLatin1Char('`') && i >= resume[InlineCode]) {
+      const int close = findToken(text, QLatin1String("`"), i + 2, codeClose);
+      if (close >= 0)
+        addSpan(InlineCode, close + 1, i + 1, close - i - 1);
+    }
+  }
+}
+
+} // namespace Jino::Editor
@@ -0,0 +1,47 @@
+// src/editor/markdown_tokenizer.hpp
+#pragma once
+
+#include "editor/block_tokenizer.hpp"
+#include "editor/highlight_profiler.hpp"
+
+#include <QVarLengthArray>
+
+namespace Jino::Editor {
+
+// Tokenizes Markdown with a hand-written lexer. Fences, headings and block
+// quotes are recognised at the start of the line; the inline rules (links,
+// emphasis, strikethrough and code spans) are matched by one sweep over the
+// block in which every rule keeps its own resume position, so the result is
+// the same as running each rule over the whole line on its own.
+class MarkdownTokenizer : public BlockTokenizer {
+public:
+  // Inline tokens are listed in the order their spans are emitted; a later
+  // token wins where spans overlap.
+  enum Token {
+    Heading,
+    BlockQuote,
+    CodeBlock,
+    Link,
+    BoldItalic,
+    Bold,
+    Italic,
+    Strikethrough,
+    InlineCode,
+    TokenCount
+  };
+
+  MarkdownTokenizer();
+
+  int tokenize(const QString &text, int previousState,
+               QVector<TokenSpan> &spans) const override;
+
+private:
+  using InlineSpans = QVarLengthArray<TokenSpan, 16>;
+
+  void scanInline(const QString &text, int fenceEnd,
+                  InlineSpans &inlineSpans) const;
+
+  mutable HighlightProfiler profiler;
+};
+
+} // namespace Jino::Editor
@@ -1,36 +1,19 @@
 // src/editor/org_syntax_highlighter.hpp
 #pragma once
 
-#include <QRegularExpression>
-#include <QSyntaxHighlighter>
-#include <QTextCharFormat>
+#include "editor/lazy_syntax_highlighter.hpp"
 
 class QTextDocument;
 
 namespace Jino::Editor {
 
-class OrgSyntaxHighlighter : public QSyntaxHighlighter {
+// Org highlighting: OrgTokenizer on the worker side, the colours for its
+// tokens here.
+class OrgSyntaxHighlighter : public LazySyntaxHighlighter {
   Q_OBJECT
 
 public:
-  explicit OrgSyntaxHighlighter(QTextDocument *parent = nullptr);
-
-protected:
-  void highlightBlock(const QString &text) override;
-
-private:
-  struct HighlightingRule {
-    QRegularExpression pattern;
-    QTextCharFormat format;
-    int captureGroup = 0;
-  };
-  QVector<HighlightingRule> highlightingRules;
-
-  QTextCharFormat headlineFormat[4];
-  QTextCharFormat boldFormat;
-  QTextCharFormat italicFormat;
-  QTextCharFormat codeFormat;
-  QTextCharFormat linkFormat;
+  explicit OrgSyntaxHighlighter(QTextDocument *parent);
 };
 
 } // namespace Jino::Editor
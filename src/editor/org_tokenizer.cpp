@@ -0,0 +1,124 @@
+#include "editor/org_tokenizer.hpp"
+#include "editor/lexer_util.hpp"
+
+namespace Jino::Editor {
+
+using Lexer::findNext;
+using Lexer::findToken;
+using Lexer::hasTokenAt;
+using Lexer::isWordChar;
+using Lexer::NextToken;
+
+namespace {
+bool isCodeMarker(QChar c) {
+  return c == QLatin1Char('=') || c == QLatin1Char('~');
+}
+
+// Bold and italic markup: the marker is not glued to a word or another
+// marker on the outside, and the text inside neither starts nor ends with
+// whitespace or the marker.
+bool opensEmphasis(const QString &text, int i, QChar marker) {
+  if (i > 0 && (text.at(i - 1) == marker || isWordChar(text.at(i - 1))))
+    return false;
+  return i + 1 < text.size() && !text.at(i + 1).isSpace() &&
+         text.at(i + 1) != marker;
+}
+
+int findEmphasisCloser(const QString &text, QChar marker, int from,
+                       NextToken &memo) {
+  return findNext(text, from, memo, [&](int j) {
+    const QChar before = text.at(j - 1);
+    return text.at(j) == marker && !before.isSpace() && before != marker &&
+           (j + 1 == text.size() || (text.at(j + 1) != marker &&
+                                     !isWordChar(text.at(j + 1))));
+  });
+}
+
+// Verbatim and code: any of "=" or "~" opens and closes.
+int findCodeCloser(const QString &text, int from, NextToken &memo) {
+  return findNext(text, from, memo, [&](int j) {
+    const QChar before = text.at(j - 1);
+    return isCodeMarker(text.at(j)) && !isCodeMarker(before) &&
+           !before.isSpace();
+  });
+}
+} // namespace
+
+OrgTokenizer::OrgTokenizer() : profiler("Org") {}
+
+int OrgTokenizer::tokenize(const QString &text, int previousState,
+                           QVector<TokenSpan> &spans) const {
+  Q_UNUSED(previousState);
+  HighlightProfiler::Scope timing(profiler, text.size());
+
+  int stars = 0;
+  while (stars < text.length() && text.at(stars) == QLatin1Char('*'))
+    ++stars;
+  if (stars > 0 && stars < text.length() && text.at(stars).isSpace()) {
+    spans.append({0, text.length(), Headline1 + qMin(stars, 4) - 1});
+    return 0;
+  }
+
+  InlineSpans inlineSpans;
+  scanInline(text, inlineSpans);
+  for (int token = Bold; token < TokenCount; ++token) {
+    for (const TokenSpan &span : qAsConst(inlineSpans)) {
+      if (span.token == token)
+        spans.append(span);
+    }
+  }
+  return 0;
+}
+
+// Every rule resumes after its own previous match, the way a separate
+// global match per rule would, and closers are found through memoised
+// searches, so the sweep stays linear in the block length.
+void OrgTokenizer::scanInline(const QString &text,
+                              InlineSpans &inlineSpans) const {
+  const int length = text.length();
+  int resume[TokenCount] = {};
+  NextToken boldClose, italicClose, codeClose, linkClose, linkDescription;
+
+  const auto addSpan = [&](Token token, int matchEnd, int start,
+                           int spanLength) {
+    resume[token] = matchEnd;
+    inlineSpans.append({start, spanLength, token});
+  };
+
+  for (int i = 0; i < length; ++i) {
+    const QChar c = text.at(i);
+
+    if (c == QLatin1Char('*') || c == QLatin1Char('/')) {
+      const Token token = c == QLatin1Char('*') ? Bold : Italic;
+      if (i >= resume[token] && opensEmphasis(text, i, c)) {
+        const int close = findEmphasisCloser(
+            text, c, i + 3, token == Bold ? boldClose : italicClose);
+        if (close >= 0)
+          addSpan(token, close + 1, i + 1, close - i - 1);
+      }
+    } else if (isCodeMarker(c)) {
+      if (i >= resume[Code] && i + 1 < length &&
+          !isCodeMarker(text.at(i + 1)) && !text.at(i + 1).isSpace()) {
+        const int close = findCodeCloser(text, i + 3, codeClose);
+        if (close >= 0)
+          addSpan(Code, close + 1, i + 1, close - i - 1);
+      }
+    } else if (c == QLatin1Char('[') && i >= resume[Link] &&
+               hasTokenAt(text, i, QLatin1String("[["))) {
+      // [[target]] or [[target][description]]; neither part may be empty.
+      const int close = findToken(text, QLatin1String("]"), i + 2, linkClose);
+      if (close > i + 2) {
+        if (hasTokenAt(text, close, QLatin1String("]["))) {
+          const int end = findToken(text, QLatin1String("]"), close + 2,
+                                    linkDescription);
+          if (end > close + 2 && hasTokenAt(text, end, QLatin1String("]]")))
+            addSpan(Link, end + 2, i, end + 2 - i);
+        } else if (hasTokenAt(text, close, QLatin1String("]]"))) {
+          addSpan(Link, close + 2, i, close + 2 - i);
+        }
+      }
+    }
+  }
+}
+
+} // namespace Jino::Editor
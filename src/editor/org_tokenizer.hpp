@@ -0,0 +1,44 @@
+// src/editor/org_tokenizer.hpp
+#pragma once
+
+#include "editor/block_tokenizer.hpp"
+#include "editor/highlight_profiler.hpp"
+
+#include <QVarLengthArray>
+
+namespace Jino::Editor {
+
+// Tokenizes Org markup with a hand-written lexer. Headlines are classified
+// by counting leading stars; bold, italic, verbatim/code and [[links]] are
+// matched by one sweep over the block in which every rule keeps its own
+// resume position.
+class OrgTokenizer : public BlockTokenizer {
+public:
+  // Inline tokens are listed in the order their spans are emitted; a later
+  // token wins where spans overlap.
+  enum Token {
+    Headline1,
+    Headline2,
+    Headline3,
+    HeadlineOther,
+    Bold,
+    Italic,
+    Code,
+    Link,
+    TokenCount
+  };
+
+  OrgTokenizer();
+
+  int tokenize(const QString &text, int previousState,
+               QVector<TokenSpan> &spans) const override;
+
+private:
+  using InlineSpans = QVarLengthArray<TokenSpan, 16>;
+
+  void scanInline(const QString &text, InlineSpans &inlineSpans) const;
+
+  mutable HighlightProfiler profiler;
+};
+
+} // namespace Jino::Editor
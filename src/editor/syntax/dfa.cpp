@@ -0,0 +1,490 @@
+#include "editor/syntax/dfa.hpp"
+
+#include <QBitArray>
+#include <QHash>
+
+#include <algorithm>
+#include <climits>
+
+namespace Jino::Editor::Syntax {
+
+namespace {
+constexpr int MAX_DFA_STATES = 20000;
+constexpr int CODE_UNITS = 0x10000;
+
+// Sorted, non-overlapping inclusive ranges of UTF-16 code units.
+using Ranges = QVector<QPair<int, int>>;
+
+Ranges normalized(Ranges ranges) {
+  std::sort(ranges.begin(), ranges.end());
+  Ranges merged;
+  for (const auto &range : qAsConst(ranges)) {
+    if (!merged.isEmpty() && range.first <= merged.last().second + 1)
+      merged.last().second = qMax(merged.last().second, range.second);
+    else
+      merged.append(range);
+  }
+  return merged;
+}
+
+Ranges complement(const Ranges &ranges) {
+  Ranges result;
+  int next = 0;
+  for (const auto &range : ranges) {
+    if (range.first > next)
+      result.append({next, range.first - 1});
+    next = range.second + 1;
+  }
+  if (next < CODE_UNITS)
+    result.append({next, CODE_UNITS - 1});
+  return result;
+}
+
+bool contains(const Ranges &ranges, int c) {
+  const auto it = std::upper_bound(
+      ranges.begin(), ranges.end(), c,
+      [](int value, const QPair<int, int> &range) {
+        return value < range.first;
+      });
+  return it != ranges.begin() && (it - 1)->second >= c;
+}
+
+const Ranges DIGITS = {{'0', '9'}};
+const Ranges WORD = {{'0', '9'}, {'A', 'Z'}, {'_', '_'}, {'a', 'z'},
+                     {0x80, CODE_UNITS - 1}};
+const Ranges SPACE = {{'\t', '\t'}, {0x0b, 0x0d}, {' ', ' '}, {0xa0, 0xa0}};
+
+struct NfaState {
+  int set = -1;
+  int target = -1;
+  QVector<int> epsilon;
+  int accept = -1;
+};
+
+struct Fragment {
+  int start;
+  int end;
+};
+
+// Thompson construction over the dialect described in dfa.hpp. Every
+// fragment has one entry and one exit state; errors are reported through
+// `error` and stop the parse.
+class RegexParser {
+public:
+  RegexParser(QVector<NfaState> &states, QVector<Ranges> &sets)
+      : states(states), sets(sets) {}
+
+  bool parse(const QString &source, Fragment &fragment, QString &message) {
+    pattern = source;
+    position = 0;
+    error.clear();
+    fragment = parseAlternation();
+    if (error.isEmpty() && position < pattern.size())
+      fail(QStringLiteral("unbalanced ')'"));
+    message = error;
+    return error.isEmpty();
+  }
+
+private:
+  int newState() {
+    states.append(NfaState());
+    return states.size() - 1;
+  }
+
+  void fail(const QString &message) {
+    if (error.isEmpty())
+      error = QStringLiteral("%1 at offset %2").arg(message).arg(position);
+  }
+
+  bool atEnd() const { return position >= pattern.size(); }
+  QChar peek() const { return pattern.at(position); }
+
+  Fragment empty() {
+    const Fragment fragment{newState(), newState()};
+    states[fragment.start].epsilon.append(fragment.end);
+    return fragment;
+  }
+
+  Fragment characters(const Ranges &ranges) {
+    const Fragment fragment{newState(), newState()};
+    sets.append(normalized(ranges));
+    states[fragment.start].set = sets.size() - 1;
+    states[fragment.start].target = fragment.end;
+    return fragment;
+  }
+
+  Fragment parseAlternation() {
+    Fragment fragment = parseConcatenation();
+    while (error.isEmpty() && !atEnd() && peek() == QLatin1Char('|')) {
+      ++position;
+      const Fragment other = parseConcatenation();
+      const Fragment joined{newState(), newState()};
+      states[joined.start].epsilon << fragment.start << other.start;
+      states[fragment.end].epsilon.append(joined.end);
+      states[other.end].epsilon.append(joined.end);
+      fragment = joined;
+    }
+    return fragment;
+  }
+
+  Fragment parseConcatenation() {
+    Fragment fragment = empty();
+    while (error.isEmpty() && !atEnd() && peek() != QLatin1Char('|') &&
+           peek() != QLatin1Char(')')) {
+      const Fragment next = parseRepeat();
+      states[fragment.end].epsilon.append(next.start);
+      fragment.end = next.end;
+    }
+    return fragment;
+  }
+
+  Fragment parseRepeat() {
+    Fragment fragment = parseAtom();
+    while (error.isEmpty() && !atEnd()) {
+      const QChar c = peek();
+      if (c != QLatin1Char('*') && c != QLatin1Char('+') &&
+          c != QLatin1Char('?'))
+        break;
+      ++position;
+      const Fragment repeated{newState(), newState()};
+      states[repeated.start].epsilon.append(fragment.start);
+      if (c != QLatin1Char('+'))
+        states[repeated.start].epsilon.append(repeated.end);
+      if (c != QLatin1Char('?'))
+        states[fragment.end].epsilon.append(fragment.start);
+      states[fragment.end].epsilon.append(repeated.end);
+      fragment = repeated;
+    }
+    return fragment;
+  }
+
+  Fragment parseAtom() {
+    const QChar c = peek();
+    ++position;
+    switch (c.unicode()) {
+    case '(': {
+      if (pattern.midRef(position, 2) == QLatin1String("?:"))
+        position += 2;
+      const Fragment inner = parseAlternation();
+      if (atEnd() || peek() != QLatin1Char(')'))
+        fail(QStringLiteral("missing ')'"));
+      else
+        ++position;
+      return inner;
+    }
+    case '[': {
+      Ranges ranges;
+      parseClass(ranges);
+      return characters(ranges);
+    }
+    case '.':
+      return characters({{0, '\n' - 1}, {'\n' + 1, CODE_UNITS - 1}});
+    case '\\': {
+      Ranges ranges;
+      parseEscape(ranges);
+      return characters(ranges);
+    }
+    case '*':
+    case '+':
+    case '?':
+      fail(QStringLiteral("quantifier without operand"));
+      return empty();
+    case '^':
+    case '$':
+      fail(QStringLiteral("anchors are not supported"));
+      return empty();
+    case '{':
+      fail(QStringLiteral("counted repetition is not supported"));
+      return empty();
+    default:
+      return characters({{c.unicode(), c.unicode()}});
+    }
+  }
+
+  // Called after the backslash.
+  void parseEscape(Ranges &ranges) {
+    if (atEnd()) {
+      fail(QStringLiteral("trailing backslash"));
+      return;
+    }
+    const QChar c = peek();
+    ++position;
+    switch (c.unicode()) {
+    case 'd':
+      ranges << DIGITS;
+      return;
+    case 'D':
+      ranges << complement(DIGITS);
+      return;
+    case 'w':
+      ranges << WORD;
+      return;
+    case 'W':
+      ranges << complement(WORD);
+      return;
+    case 's':
+      ranges << SPACE;
+      return;
+    case 'S':
+      ranges << complement(SPACE);
+      return;
+    case 't':
+      ranges.append({'\t', '\t'});
+      return;
+    case 'n':
+      ranges.append({'\n', '\n'});
+      return;
+    case 'r':
+      ranges.append({'\r', '\r'});
+      return;
+    case 'f':
+      ranges.append({'\f', '\f'});
+      return;
+    case 'v':
+      ranges.append({'\v', '\v'});
+      return;
+    case 'x':
+    case 'u': {
+      const int digits = c == QLatin1Char('x') ? 2 : 4;
+      bool ok = false;
+      const int code = pattern.midRef(position, digits).toInt(&ok, 16);
+      if (!ok || position + digits > pattern.size()) {
+        fail(QStringLiteral("bad hexadecimal escape"));
+        return;
+      }
+      position += digits;
+      ranges.append({code, code});
+      return;
+    }
+    default:
+      // Letters and digits are kept for escapes with a meaning (\b, \1);
+      // taking them as literals would silently match something else.
+      if (c.isLetterOrNumber()) {
+        fail(QStringLiteral("unsupported escape"));
+        return;
+      }
+      ranges.append({c.unicode(), c.unicode()});
+      return;
+    }
+  }
+
+  // Called after the opening bracket. A "]" right after "[" or "[^" is a
+  // literal.
+  void parseClass(Ranges &ranges) {
+    bool negated = false;
+    if (!atEnd() && peek() == QLatin1Char('^')) {
+      negated = true;
+      ++position;
+    }
+    Ranges members;
+    bool first = true;
+    while (error.isEmpty()) {
+      if (atEnd()) {
+        fail(QStringLiteral("missing ']'"));
+        return;
+      }
+      QChar c = peek();
+      if (c == QLatin1Char(']') && !first)
+        break;
+      first = false;
+      ++position;
+      int low = c.unicode();
+      if (c == QLatin1Char('\\')) {
+        Ranges escaped;
+        parseEscape(escaped);
+        if (escaped.size() != 1 || escaped.first().first !=
+                                       escaped.first().second) {
+          members << escaped;
+          continue;
+        }
+        low = escaped.first().first;
+      }
+      int high = low;
+      if (position + 1 < pattern.size() && peek() == QLatin1Char('-') &&
+          pattern.at(position + 1) != QLatin1Char(']')) {
+        ++position;
+        c = peek();
+        ++position;
+        high = c.unicode();
+        if (c == QLatin1Char('\\')) {
+          Ranges escaped;
+          parseEscape(escaped);
+          if (escaped.size() != 1 ||
+              escaped.first().first != escaped.first().second) {
+            fail(QStringLiteral("bad range in class"));
+            return;
+          }
+          high = escaped.first().first;
+        }
+        if (high < low) {
+          fail(QStringLiteral("reversed range in class"));
+          return;
+        }
+      }
+      members.append({low, high});
+    }
+    ++position;
+    members = normalized(members);
+    ranges << (negated ? complement(members) : members);
+  }
+
+  QVector<NfaState> &states;
+  QVector<Ranges> &sets;
+  QString pattern;
+  int position = 0;
+  QString error;
+};
+
+void addClosure(const QVector<NfaState> &states, int state, QVector<int> &set,
+                QVector<int> &marks, int stamp) {
+  QVector<int> stack{state};
+  while (!stack.isEmpty()) {
+    const int current = stack.takeLast();
+    if (marks[current] == stamp)
+      continue;
+    marks[current] = stamp;
+    set.append(current);
+    for (int next : states.at(current).epsilon)
+      stack.append(next);
+  }
+}
+} // namespace
+
+bool Dfa::compile(const QVector<Rule> &rules, QString &error) {
+  QVector<NfaState> states;
+  QVector<Ranges> sets;
+  RegexParser parser(states, sets);
+  states.append(NfaState());
+  for (int index = 0; index < rules.size(); ++index) {
+    Fragment fragment;
+    QString message;
+    if (!parser.parse(rules.at(index).pattern, fragment, message)) {
+      error = QStringLiteral("pattern \"%1\": %2")
+                  .arg(rules.at(index).pattern, message);
+      return false;
+    }
+    states[0].epsilon.append(fragment.start);
+    states[fragment.end].accept = index;
+  }
+
+  // Split the code units into classes that no set tells apart.
+  QVector<int> bounds{0, CODE_UNITS};
+  for (const Ranges &set : qAsConst(sets)) {
+    for (const auto &range : set)
+      bounds << range.first << range.second + 1;
+  }
+  std::sort(bounds.begin(), bounds.end());
+  bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+  QHash<QBitArray, int> classBySignature;
+  QVector<QBitArray> signatures;
+  wideClasses.clear();
+  for (int i = 0; i + 1 < bounds.size(); ++i) {
+    const int first = bounds.at(i);
+    const int last = bounds.at(i + 1) - 1;
+    QBitArray signature(sets.size());
+    for (int s = 0; s < sets.size(); ++s)
+      signature.setBit(s, contains(sets.at(s), first));
+    auto found = classBySignature.constFind(signature);
+    if (found == classBySignature.constEnd()) {
+      found = classBySignature.insert(signature, signatures.size());
+      signatures.append(signature);
+    }
+    for (int c = first; c <= qMin(last, 127); ++c)
+      asciiClasses[c] = found.value();
+    if (last >= 128) {
+      const int from = qMax(first, 128);
+      if (!wideClasses.isEmpty() &&
+          wideClasses.last().characterClass == found.value())
+        wideClasses.last().last = ushort(last);
+      else
+        wideClasses.append({ushort(from), ushort(last), found.value()});
+    }
+  }
+  classCount = signatures.size();
+
+  // Subset construction; state 0 is the start state.
+  QVector<int> marks(states.size(), 0);
+  int stamp = 1;
+  QHash<QVector<int>, int> stateIds;
+  QVector<QVector<int>> pending;
+  QVector<int> start;
+  addClosure(states, 0, start, marks, stamp++);
+  std::sort(start.begin(), start.end());
+  stateIds.insert(start, 0);
+  pending.append(start);
+  transitions.clear();
+  accepting.clear();
+  for (int index = 0; index < pending.size(); ++index) {
+    const QVector<int> current = pending.at(index);
+    // On equal length the rule listed first wins.
+    int accept = INT_MAX;
+    for (int state : current) {
+      if (states.at(state).accept >= 0)
+        accept = qMin(accept, states.at(state).accept);
+    }
+    accepting.append(accept == INT_MAX ? -1 : rules.at(accept).id);
+    for (int characterClass = 0; characterClass < classCount;
+         ++characterClass) {
+      const QBitArray &signature = signatures.at(characterClass);
+      QVector<int> next;
+      for (int state : current) {
+        const NfaState &nfa = states.at(state);
+        if (nfa.set >= 0 && signature.testBit(nfa.set))
+          addClosure(states, nfa.target, next, marks, stamp);
+      }
+      ++stamp;
+      if (next.isEmpty()) {
+        transitions.append(-1);
+        continue;
+      }
+      std::sort(next.begin(), next.end());
+      auto found = stateIds.constFind(next);
+      if (found == stateIds.constEnd()) {
+        if (pending.size() == MAX_DFA_STATES) {
+          error = QStringLiteral("rules need more than %1 automaton states")
+                      .arg(MAX_DFA_STATES);
+          return false;
+        }
+        found = stateIds.insert(next, pending.size());
+        pending.append(next);
+      }
+      transitions.append(found.value());
+    }
+  }
+  return true;
+}
+
+// Longest match from `from`; the result has rule -1 if nothing matched.
+// Empty matches are never reported.
+Dfa::Match Dfa::match(const QString &text, int from) const {
+  Match best;
+  const int *table = transitions.constData();
+  const int *accepts = accepting.constData();
+  const QChar *data = text.constData();
+  int state = 0;
+  for (int i = from; i < text.size(); ++i) {
+    state = table[state * classCount + classOf(data[i].unicode())];
+    if (state < 0)
+      break;
+    if (accepts[state] >= 0) {
+      best.rule = accepts[state];
+      best.length = i + 1 - from;
+    }
+  }
+  return best;
+}
+
+int Dfa::stateCount() const { return accepting.size(); }
+
+int Dfa::classOf(ushort c) const {
+  if (c < 128)
+    return asciiClasses[c];
+  const auto it = std::upper_bound(
+      wideClasses.begin(), wideClasses.end(), c,
+      [](ushort value, const WideClass &range) {
+        return value < range.first;
+      });
+  return (it - 1)->characterClass;
+}
+
+} // namespace Jino::Editor::Syntax
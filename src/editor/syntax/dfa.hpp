@@ -0,0 +1,56 @@
+// src/editor/syntax/dfa.hpp
+#pragma once
+
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+namespace Jino::Editor::Syntax {
+
+// A set of token rules compiled into one deterministic automaton, so a
+// single pass from a position finds the longest match over all rules at
+// once; on equal length the rule listed first wins.
+//
+// Patterns use a small regular expression dialect: literals, ".", classes
+// ("[a-z_]", "[^\"\\\\]"), the escapes \d \w \s (and their negations), \t
+// \n \r \f \v \xHH \uHHHH, grouping with "(...)" or "(?:...)", "|" and the
+// quantifiers "*", "+" and "?". Anchors, back-references and counted
+// repetition ("{n,m}") are not supported and fail to compile, as does any
+// other escaped letter or digit (\b, \A, \1); other escaped characters
+// stand for themselves, so a literal brace is "\\{". A rule that only
+// applies at the start of a line is marked by its grammar instead.
+// Characters are UTF-16 code units; \w counts every code unit above ASCII as
+// a word character.
+class Dfa {
+public:
+  struct Rule {
+    QString pattern;
+    int id;
+  };
+
+  struct Match {
+    int rule = -1;
+    int length = 0;
+  };
+
+  bool compile(const QVector<Rule> &rules, QString &error);
+  Match match(const QString &text, int from) const;
+  int stateCount() const;
+
+private:
+  struct WideClass {
+    ushort first;
+    ushort last;
+    int characterClass;
+  };
+
+  int classOf(ushort c) const;
+
+  int classCount = 0;
+  int asciiClasses[128] = {};
+  QVector<WideClass> wideClasses;
+  QVector<int> transitions;
+  QVector<int> accepting;
+};
+
+} // namespace Jino::Editor::Syntax
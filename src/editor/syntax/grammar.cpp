@@ -0,0 +1,131 @@
+#include "editor/syntax/grammar.hpp"
+
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace Jino::Editor::Syntax {
+
+namespace {
+bool readStyle(const QJsonObject &object, Grammar::Style &style) {
+  style.color = QColor(object.value("color").toString());
+  style.bold = object.value("bold").toBool();
+  style.italic = object.value("italic").toBool();
+  style.underline = object.value("underline").toBool();
+  return style.color.isValid();
+}
+} // namespace
+
+std::shared_ptr<const Grammar> Grammar::load(const QString &path,
+                                             QString &error) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    error = file.errorString();
+    return nullptr;
+  }
+  QJsonParseError parseError;
+  const QJsonDocument document =
+      QJsonDocument::fromJson(file.readAll(), &parseError);
+  if (!document.isObject()) {
+    error = parseError.errorString();
+    return nullptr;
+  }
+  const QJsonObject root = document.object();
+
+  std::shared_ptr<Grammar> grammar(new Grammar);
+  grammar->grammarName = root.value("name").toString();
+  if (grammar->grammarName.isEmpty()) {
+    error = QStringLiteral("missing name");
+    return nullptr;
+  }
+  for (const QJsonValue &extension : root.value("extensions").toArray())
+    grammar->fileExtensions.append(extension.toString().toLower());
+
+  QHash<QString, int> tokens;
+  const QJsonObject styles = root.value("styles").toObject();
+  for (auto it = styles.begin(); it != styles.end(); ++it) {
+    Style style;
+    if (!readStyle(it.value().toObject(), style)) {
+      error = QStringLiteral("style \"%1\" has no valid color").arg(it.key());
+      return nullptr;
+    }
+    tokens.insert(it.key(), grammar->tokenStyles.size());
+    grammar->tokenStyles.append(style);
+  }
+  const auto tokenId = [&](const QJsonValue &value, int &id) {
+    id = -1;
+    if (value.isUndefined())
+      return true;
+    id = tokens.value(value.toString(), -1);
+    if (id < 0)
+      error = QStringLiteral("unknown style \"%1\"").arg(value.toString());
+    return id >= 0;
+  };
+
+  const QJsonArray contexts = root.value("contexts").toArray();
+  if (contexts.isEmpty()) {
+    error = QStringLiteral("no contexts");
+    return nullptr;
+  }
+  QHash<QString, int> contextIds;
+  for (const QJsonValue &context : contexts)
+    contextIds.insert(context.toObject().value("name").toString(),
+                      contextIds.size());
+
+  for (const QJsonValue &value : contexts) {
+    const QJsonObject object = value.toObject();
+    Context context;
+    context.name = object.value("name").toString();
+    if (!tokenId(object.value("token"), context.token))
+      return nullptr;
+    QVector<Dfa::Rule> lineStartRules;
+    QVector<Dfa::Rule> anywhereRules;
+    for (const QJsonValue &ruleValue : object.value("rules").toArray()) {
+      const QJsonObject ruleObject = ruleValue.toObject();
+      Rule rule;
+      if (!tokenId(ruleObject.value("token"), rule.token))
+        return nullptr;
+      rule.next = -1;
+      if (ruleObject.contains("next")) {
+        const QString next = ruleObject.value("next").toString();
+        rule.next = contextIds.value(next, -1);
+        if (rule.next < 0) {
+          error = QStringLiteral("unknown context \"%1\"").arg(next);
+          return nullptr;
+        }
+      }
+      const QString pattern = ruleObject.value("match").toString();
+      const int id = context.rules.size();
+      context.rules.append(rule);
+      if (pattern.startsWith(QLatin1Char('^'))) {
+        lineStartRules.append({pattern.mid(1), id});
+      } else {
+        lineStartRules.append({pattern, id});
+        anywhereRules.append({pattern, id});
+      }
+    }
+    if (!context.lineStart.compile(lineStartRules, error) ||
+        !context.anywhere.compile(anywhereRules, error)) {
+      error = QStringLiteral("context \"%1\": %2").arg(context.name, error);
+      return nullptr;
+    }
+    grammar->grammarContexts.append(context);
+  }
+  return grammar;
+}
+
+const QString &Grammar::name() const { return grammarName; }
+
+const QStringList &Grammar::extensions() const { return fileExtensions; }
+
+const QVector<Grammar::Style> &Grammar::styles() const {
+  return tokenStyles;
+}
+
+const QVector<Grammar::Context> &Grammar::contexts() const {
+  return grammarContexts;
+}
+
+} // namespace Jino::Editor::Syntax
@@ -0,0 +1,77 @@
+// src/editor/syntax/grammar.hpp
+#pragma once
+
+#include "editor/syntax/dfa.hpp"
+
+#include <QColor>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <memory>
+
+namespace Jino::Editor::Syntax {
+
+// A highlighting grammar loaded from a JSON description:
+//
+//   {
+//     "name": "C++",
+//     "extensions": ["cpp", "hpp"],
+//     "styles": { "comment": { "color": "#565f89", "italic": true }, ... },
+//     "contexts": [
+//       { "name": "main", "rules": [
+//           { "match": "//.*", "token": "comment" },
+//           { "match": "/\\*", "token": "comment", "next": "comment" },
+//           { "match": "^\\s*#\\s*\\w+", "token": "preprocessor" } ] },
+//       { "name": "comment", "token": "comment", "rules": [
+//           { "match": "\\*/", "token": "comment", "next": "main" } ] } ]
+//   }
+//
+// Text is scanned in one context at a time, starting in the first one. At
+// every position the rules of the current context are tried together and
+// the longest match wins, the earlier rule on a tie; "next" switches the
+// context after the match. A rule starting with "^" only applies at the
+// start of a line. Text no rule matches gets the context's token, if any.
+// The context a line ends in carries over to the next line. Each context's
+// rules are compiled into two DFAs when the grammar is loaded, one for the
+// start of a line and one for everywhere else.
+class Grammar {
+public:
+  struct Style {
+    QColor color;
+    bool bold = false;
+    bool italic = false;
+    bool underline = false;
+  };
+
+  struct Rule {
+    int token;
+    int next;
+  };
+
+  struct Context {
+    QString name;
+    int token = -1;
+    QVector<Rule> rules;
+    Dfa lineStart;
+    Dfa anywhere;
+  };
+
+  static std::shared_ptr<const Grammar> load(const QString &path,
+                                             QString &error);
+
+  const QString &name() const;
+  const QStringList &extensions() const;
+  const QVector<Style> &styles() const;
+  const QVector<Context> &contexts() const;
+
+private:
+  Grammar() = default;
+
+  QString grammarName;
+  QStringList fileExtensions;
+  QVector<Style> tokenStyles;
+  QVector<Context> grammarContexts;
+};
+
+} // namespace Jino::Editor::Syntax
@@ -0,0 +1,52 @@
+#include "editor/syntax/grammar_tokenizer.hpp"
+#include "editor/syntax/grammar.hpp"
+
+namespace Jino::Editor::Syntax {
+
+namespace {
+// Extends the previous span instead of starting a new one when the token
+// continues, so runs of unmatched text stay a single span.
+void appendSpan(QVector<TokenSpan> &spans, int start, int length,
+                int token) {
+  if (!spans.isEmpty() && spans.last().token == token &&
+      spans.last().start + spans.last().length == start)
+    spans.last().length += length;
+  else
+    spans.append({start, length, token});
+}
+} // namespace
+
+GrammarTokenizer::GrammarTokenizer(std::shared_ptr<const Grammar> grammar)
+    : grammar(std::move(grammar)),
+      profileName(this->grammar->name().toUtf8()),
+      profiler(profileName.constData()) {}
+
+int GrammarTokenizer::tokenize(const QString &text, int previousState,
+                               QVector<TokenSpan> &spans) const {
+  HighlightProfiler::Scope timing(profiler, text.size());
+  const QVector<Grammar::Context> &contexts = grammar->contexts();
+  int context =
+      previousState >= 0 && previousState < contexts.size() ? previousState
+                                                            : 0;
+  int position = 0;
+  while (position < text.size()) {
+    const Grammar::Context &current = contexts.at(context);
+    const Dfa &dfa = position == 0 ? current.lineStart : current.anywhere;
+    const Dfa::Match match = dfa.match(text, position);
+    if (match.rule < 0) {
+      if (current.token >= 0)
+        appendSpan(spans, position, 1, current.token);
+      ++position;
+      continue;
+    }
+    const Grammar::Rule &rule = current.rules.at(match.rule);
+    if (rule.token >= 0)
+      appendSpan(spans, position, match.length, rule.token);
+    if (rule.next >= 0)
+      context = rule.next;
+    position += match.length;
+  }
+  return context;
+}
+
+} // namespace Jino::Editor::Syntax
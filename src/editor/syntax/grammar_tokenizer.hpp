@@ -0,0 +1,30 @@
+// src/editor/syntax/grammar_tokenizer.hpp
+#pragma once
+
+#include "editor/block_tokenizer.hpp"
+#include "editor/highlight_profiler.hpp"
+
+#include <QByteArray>
+
+#include <memory>
+
+namespace Jino::Editor::Syntax {
+
+class Grammar;
+
+// Runs a Grammar over a block. The block state is the index of the context
+// the line ends in. Token ids are the grammar's style indices.
+class GrammarTokenizer : public BlockTokenizer {
+public:
+  explicit GrammarTokenizer(std::shared_ptr<const Grammar> grammar);
+
+  int tokenize(const QString &text, int previousState,
+               QVector<TokenSpan> &spans) const override;
+
+private:
+  std::shared_ptr<const Grammar> grammar;
+  QByteArray profileName;
+  mutable HighlightProfiler profiler;
+};
+
+} // namespace Jino::Editor::Syntax
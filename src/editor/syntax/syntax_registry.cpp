@@ -0,0 +1,73 @@
+#include "editor/syntax/syntax_registry.hpp"
+#include "editor/syntax/grammar.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+namespace Jino::Editor::Syntax {
+
+namespace {
+const QString GRAMMAR_RESOURCE_DIR = QStringLiteral(":/grammars");
+} // namespace
+
+QString FileMode::label() const {
+  if (type == Constants::EditorFileType::Code)
+    return grammar;
+  return Constants::editorModeToString(type);
+}
+
+Registry &Registry::instance() {
+  static Registry registry;
+  return registry;
+}
+
+Registry::Registry() {
+  using Constants::EditorFileType;
+  fileModes = {{EditorFileType::Text, QString()},
+               {EditorFileType::Org, QString()},
+               {EditorFileType::Markdown, QString()}};
+  byExtension.insert(QStringLiteral("org"), fileModes.at(1));
+  byExtension.insert(QStringLiteral("md"), fileModes.at(2));
+
+  const QDir dir(GRAMMAR_RESOURCE_DIR);
+  const QStringList files = dir.entryList({QStringLiteral("*.json")},
+                                          QDir::Files, QDir::Name);
+  for (const QString &file : files) {
+    QString error;
+    std::shared_ptr<const Grammar> loaded =
+        Grammar::load(dir.filePath(file), error);
+    if (!loaded) {
+      qWarning() << "Failed to load grammar" << file << ":" << error;
+      continue;
+    }
+    const QString &name = loaded->name();
+    bool taken = false;
+    for (const FileMode &mode : fileModes)
+      taken = taken || mode.label().compare(name, Qt::CaseInsensitive) == 0;
+    if (taken) {
+      qWarning() << "Ignoring grammar" << file << ": mode" << name
+                 << "already exists";
+      continue;
+    }
+    const FileMode mode{EditorFileType::Code, name};
+    grammars.insert(name, loaded);
+    fileModes.append(mode);
+    for (const QString &extension : loaded->extensions()) {
+      if (!byExtension.contains(extension.toLower()))
+        byExtension.insert(extension.toLower(), mode);
+    }
+  }
+}
+
+std::shared_ptr<const Grammar> Registry::grammar(const QString &name) const {
+  return grammars.value(name);
+}
+
+FileMode Registry::modeForPath(const QString &path) const {
+  return byExtension.value(QFileInfo(path).suffix().toLower(), FileMode());
+}
+
+QVector<FileMode> Registry::modes() const { return fileModes; }
+
+} // namespace Jino::Editor::Syntax
@@ -0,0 +1,49 @@
+// src/editor/syntax/syntax_registry.hpp
+#pragma once
+
+#include "core/constants.hpp"
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+namespace Jino::Editor::Syntax {
+
+class Grammar;
+
+// An editor mode as offered to the user: one of the built-in file types,
+// or EditorFileType::Code together with the name of a grammar.
+struct FileMode {
+  Constants::EditorFileType type = Constants::EditorFileType::Text;
+  QString grammar;
+
+  QString label() const;
+
+  bool operator==(const FileMode &other) const {
+    return type == other.type && grammar == other.grammar;
+  }
+  bool operator!=(const FileMode &other) const { return !(*this == other); }
+};
+
+// The modes the editor knows about. Besides the built-in ones, every grammar
+// shipped under :/grammars becomes a mode of its own, picked by file
+// extension. Grammars are loaded and compiled once, on first use.
+class Registry {
+public:
+  static Registry &instance();
+
+  std::shared_ptr<const Grammar> grammar(const QString &name) const;
+  FileMode modeForPath(const QString &path) const;
+  QVector<FileMode> modes() const;
+
+private:
+  Registry();
+
+  QVector<FileMode> fileModes;
+  QHash<QString, std::shared_ptr<const Grammar>> grammars;
+  QHash<QString, FileMode> byExtension;
+};
+
+} // namespace Jino::Editor::Syntax
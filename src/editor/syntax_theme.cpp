@@ -0,0 +1,48 @@
+#include "editor/syntax_theme.hpp"
+#include "core/constants.hpp"
+
+namespace Jino::Editor {
+
+namespace {
+constexpr int COLOR_COUNT = 9;
+
+// The Tokyo Night colours the highlighters use, in the order of the theme
+// tables below.
+const QRgb BASE_COLORS[COLOR_COUNT] = {
+    0x7AA2F7, // blue: headings, keywords
+    0xBB9AF7, // magenta: links, types
+    0x7DCFFF, // cyan: code
+    0xF7768E, // red: bold
+    0xE0AF68, // yellow: italic, first headline
+    0x9ECE6A, // green: quotes, strings
+    0xFF9E64, // orange: numbers
+    0x565F89, // comments, strikethrough
+    0xC0CAF5, // plain headlines
+};
+
+const QRgb EVERFOREST_COLORS[COLOR_COUNT] = {
+    0x7FBBB3, 0xD699B6, 0x83C092, 0xE67E80, 0xDBBC7F,
+    0xA7C080, 0xE69875, 0x859289, 0xD3C6AA};
+
+const QRgb NIGHT_OWL_COLORS[COLOR_COUNT] = {
+    0x82AAFF, 0xC792EA, 0x7FDBCA, 0xEF5350, 0xECC48D,
+    0xADDB67, 0xF78C6C, 0x637777, 0xD6DEEB};
+
+// Keyed by QColor::rgb(), which is opaque.
+QHash<QRgb, QColor> mapColors(const QRgb (&colors)[COLOR_COUNT]) {
+  QHash<QRgb, QColor> map;
+  for (int i = 0; i < COLOR_COUNT; ++i)
+    map.insert(QColor(BASE_COLORS[i]).rgb(), QColor(colors[i]));
+  return map;
+}
+} // namespace
+
+QHash<QRgb, QColor> syntaxColorsForTheme(const QString &theme) {
+  if (theme == Constants::THEME_EVERFOREST)
+    return mapColors(EVERFOREST_COLORS);
+  if (theme == Constants::THEME_NIGHT_OWL)
+    return mapColors(NIGHT_OWL_COLORS);
+  return {};
+}
+
+} // namespace Jino::Editor
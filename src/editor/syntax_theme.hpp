@@ -0,0 +1,16 @@
+// src/editor/syntax_theme.hpp
+#pragma once
+
+#include <QColor>
+#include <QHash>
+#include <QString>
+
+namespace Jino::Editor {
+
+// Highlighting colours for the interface themes. The highlighters and the
+// bundled grammars are written against the Tokyo Night palette; a theme
+// maps each of those colours to its own counterpart. Tokyo Night itself,
+// and any theme not listed, maps nothing.
+QHash<QRgb, QColor> syntaxColorsForTheme(const QString &theme);
+
+} // namespace Jino::Editor
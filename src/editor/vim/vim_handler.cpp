@@ -1,19 +1,60 @@
 #include "editor/vim/vim_handler.hpp"
 #include "core/constants.hpp"
 #include "editor/editor_widget.hpp"
+#include "editor/vim/vim_motion.hpp"
+#include "editor/vim/vim_registers.hpp"
 
 #include <QAbstractSlider>
-#include <QApplication>
-#include <QClipboard>
 #include <QDebug>
 #include <QKeyEvent>
 #include <QScrollBar>
 #include <QTextCursor>
+#include <QTextDocument>
 
 namespace Jino::Editor::Vim {
 
+namespace {
+// The text an operator yanks, with '\n' line breaks. Linewise text always
+// ends in one, even when it reaches the end of the document.
+QString yankedText(const QTextCursor &cursor, bool linewise) {
+  QString text = cursor.selectedText();
+  text.replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+  if (linewise && !text.endsWith(QLatin1Char('\n')))
+    text += QLatin1Char('\n');
+  return text;
+}
+
+// > indents every line that has text by a shift width of spaces; < takes
+// away up to that many leading spaces, or a single leading tab.
+void shiftLines(QTextBlock block, const QTextBlock &last, bool right) {
+  for (;; block = block.next()) {
+    const QString text = block.text();
+    QTextCursor cursor(block);
+    if (right) {
+      if (!text.isEmpty())
+        cursor.insertText(
+            QString(Constants::VIM_SHIFT_WIDTH, QLatin1Char(' ')));
+    } else {
+      const int limit = qMin(Constants::VIM_SHIFT_WIDTH, text.size());
+      int width = 0;
+      while (width < limit && text.at(width) == QLatin1Char(' '))
+        ++width;
+      if (width == 0 && text.startsWith(QLatin1Char('\t')))
+        width = 1;
+      cursor.movePosition(QTextCursor::NextCharacter,
+                          QTextCursor::KeepAnchor, width);
+      cursor.removeSelectedText();
+    }
+    if (block == last)
+      break;
+  }
+}
+} // namespace
+
 VimHandler::VimHandler(EditorWidget *editor)
     : QObject(editor), editorWidget(editor) {
+  connect(editor->document(), &QTextDocument::contentsChange, this,
+          &VimHandler::trackInsertedText);
   setMode(Mode::Insert);
 }
 
@@ -24,25 +65,49 @@ void VimHandler::resetLeaderState() {
   waitingForFileSaveKey = false;
 }
 
+// Keys typed while recording are kept as they are, whichever mode they end
+// up in, and the q that stops the recording is left out. Modifiers pressed
+// on their own are neither recorded nor parsed.
 bool VimHandler::handleKeyPress(QKeyEvent *event) {
+  const KeyStroke stroke = KeyStroke::fromEvent(event);
+  if (stroke.isModifier())
+    return mode != Mode::Insert;
+  if (!recordingRegister.isNull()) {
+    if (mode != Mode::Insert && !parser.isPending() &&
+        stroke.character() == QLatin1Char('q')) {
+      Registers::instance().record(recordingRegister, recordedKeys);
+      recordingRegister = QChar();
+      recordedKeys.clear();
+      return true;
+    }
+    recordedKeys += stroke.toText();
+  }
+  return handleKeyStroke(stroke);
+}
+
+bool VimHandler::handleKeyStroke(const KeyStroke &stroke) {
   bool handled = true;
 
-  if (event->key() == Qt::Key_Escape) {
+  if (stroke.key == Qt::Key_Escape) {
+    parser.reset();
     executeCommandExitToNormalMode();
     return true;
   }
 
   switch (mode) {
   case Mode::Insert:
-
-    handled = false;
+    // Typed text goes to the editor itself; replayed text is inserted here.
+    if (replayDepth > 0)
+      processInsertModeKey(stroke);
+    else
+      handled = false;
     break;
   case Mode::Normal:
-    processNormalModeKey(event);
+    processNormalModeKey(stroke);
 
     break;
   case Mode::Visual:
-    processVisualModeKey(event);
+    processVisualModeKey(stroke);
 
     break;
   default:
@@ -52,15 +117,55 @@ bool VimHandler::handleKeyPress(QKeyEvent *event) {
   return handled;
 }
 
-void VimHandler::processInsertModeKey(QKeyEvent *event) { Q_UNUSED(event); }
+void VimHandler::processInsertModeKey(const KeyStroke &stroke) {
+  if (!editorWidget || editorWidget->editingLocked())
+    return;
+  QTextCursor cursor = textCursor();
+  switch (stroke.key) {
+  case Qt::Key_Backspace:
+    cursor.deletePreviousChar();
+    break;
+  case Qt::Key_Delete:
+    cursor.deleteChar();
+    break;
+  case Qt::Key_Return:
+  case Qt::Key_Enter:
+    cursor.insertText(QStringLiteral("\n"));
+    break;
+  case Qt::Key_Left:
+    cursor.movePosition(QTextCursor::PreviousCharacter);
+    break;
+  case Qt::Key_Right:
+    cursor.movePosition(QTextCursor::NextCharacter);
+    break;
+  case Qt::Key_Up:
+    cursor.movePosition(QTextCursor::PreviousBlock);
+    break;
+  case Qt::Key_Down:
+    cursor.movePosition(QTextCursor::NextBlock);
+    break;
+  case Qt::Key_Home:
+    cursor.movePosition(QTextCursor::StartOfBlock);
+    break;
+  case Qt::Key_End:
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    break;
+  default:
+    if (!stroke.text.isEmpty() && (stroke.key == Qt::Key_Tab ||
+                                   stroke.text.at(0).isPrint()))
+      cursor.insertText(stroke.text);
+    break;
+  }
+  setTextCursor(cursor);
+}
 
-void VimHandler::processNormalModeKey(QKeyEvent *event) {
+void VimHandler::processNormalModeKey(const KeyStroke &stroke) {
   if (!editorWidget)
     return;
 
-  const QString keyText = event->text();
-  const int key = event->key();
-  const Qt::KeyboardModifiers modifiers = event->modifiers();
+  const QString &keyText = stroke.text;
+  const int key = stroke.key;
+  const Qt::KeyboardModifiers modifiers = stroke.modifiers;
   bool keyProcessed = true;
 
   if (waitingForFileLeaderKey) {
@@ -94,22 +199,27 @@ void VimHandler::processNormalModeKey(QKeyEvent *event) {
   else if (!waitingForFileLeaderKey && !waitingForFileSaveKey) {
     keyProcessed = true;
 
-    if (editorWidget->textCursor().hasSelection()) {
-      if (keyText == "d") {
-        executeCommandCutSelection();
-        resetLeaderState();
-        return;
-      }
-      if (keyText == "y") {
-        executeCommandCopySelection();
-        resetLeaderState();
-        return;
-      }
+    switch (parser.feed(stroke)) {
+    case CommandParser::Status::Complete: {
+      const Command command = parser.command();
+      clearCommandBuffer();
+      executeCommand(command);
+      return;
+    }
+    case CommandParser::Status::Pending:
+      return;
+    case CommandParser::Status::Cancelled:
+      replayFailed = replayDepth > 0;
+      return;
+    case CommandParser::Status::Rejected:
+      break;
+    }
 
+    if (textCursor().hasSelection()) {
       if (key != Qt::Key_Escape && key != Qt::Key_V) {
-        QTextCursor cursor = editorWidget->textCursor();
+        QTextCursor cursor = textCursor();
         cursor.clearSelection();
-        editorWidget->setTextCursor(cursor);
+        setTextCursor(cursor);
       }
     }
 
@@ -122,21 +232,9 @@ void VimHandler::processNormalModeKey(QKeyEvent *event) {
       case Constants::VIM_KEY_UNDO:
         executeCommandUndo();
         break;
-      case Constants::VIM_KEY_CUT_CHAR:
-        executeCommandCutChar();
-        break;
-      case Constants::VIM_KEY_PASTE:
-        executeCommandPaste();
-        break;
       case 'v':
         executeCommandEnterVisualMode();
         break;
-
-      case Constants::VIM_KEY_DELETE_LINE:
-      case Constants::VIM_KEY_COPY_LINE:
-        commandBuffer += keyChar;
-        processCommandBuffer();
-        break;
       default:
         keyProcessed = false;
         break;
@@ -152,22 +250,6 @@ void VimHandler::processNormalModeKey(QKeyEvent *event) {
     if (!keyProcessed) {
       keyProcessed = true;
       switch (key) {
-      case Qt::Key_H:
-      case Qt::Key_Left:
-        editorWidget->moveCursor(QTextCursor::Left);
-        break;
-      case Qt::Key_L:
-      case Qt::Key_Right:
-        editorWidget->moveCursor(QTextCursor::Right);
-        break;
-      case Qt::Key_K:
-      case Qt::Key_Up:
-        editorWidget->moveCursor(QTextCursor::Up);
-        break;
-      case Qt::Key_J:
-      case Qt::Key_Down:
-        editorWidget->moveCursor(QTextCursor::Down);
-        break;
       case Qt::Key_PageUp:
         editorWidget->verticalScrollBar()->triggerAction(
             QAbstractSlider::SliderPageStepSub);
@@ -178,12 +260,6 @@ void VimHandler::processNormalModeKey(QKeyEvent *event) {
             QAbstractSlider::SliderPageStepAdd);
         editorWidget->triggerLineNumberUpdate();
         break;
-      case Qt::Key_Home:
-        editorWidget->moveCursor(QTextCursor::StartOfLine);
-        break;
-      case Qt::Key_End:
-        editorWidget->moveCursor(QTextCursor::EndOfLine);
-        break;
 
       default:
         keyProcessed = false;
@@ -191,8 +267,7 @@ void VimHandler::processNormalModeKey(QKeyEvent *event) {
       }
     }
 
-    if (keyProcessed && key != Constants::VIM_KEY_DELETE_LINE &&
-        key != Constants::VIM_KEY_COPY_LINE && key != Qt::Key_Space) {
+    if (keyProcessed && key != Qt::Key_Space) {
       clearCommandBuffer();
       resetLeaderState();
     }
@@ -207,13 +282,13 @@ void VimHandler::processNormalModeKey(QKeyEvent *event) {
   }
 }
 
-void VimHandler::processVisualModeKey(QKeyEvent *event) {
+void VimHandler::processVisualModeKey(const KeyStroke &stroke) {
   if (!editorWidget)
     return;
 
-  const QString keyText = event->text();
-  const int key = event->key();
-  const Qt::KeyboardModifiers modifiers = event->modifiers();
+  const QString &keyText = stroke.text;
+  const int key = stroke.key;
+  const Qt::KeyboardModifiers modifiers = stroke.modifiers;
   bool keyProcessed = true;
 
   if (waitingForFileLeaderKey) {
@@ -243,57 +318,43 @@ void VimHandler::processVisualModeKey(QKeyEvent *event) {
 
   else if (!waitingForFileLeaderKey && !waitingForFileSaveKey) {
     keyProcessed = true;
-    if (keyText == "d" || keyText == "x") {
-      executeCommandCutSelection();
-      executeCommandExitToNormalMode();
-    } else if (keyText == "y") {
-      executeCommandCopySelection();
-      executeCommandExitToNormalMode();
+    const CommandParser::Status status = parser.feed(stroke, true);
+    if (status == CommandParser::Status::Complete) {
+      const Command command = parser.command();
+      if (command.op == Operator::None) {
+        moveVisualCursor(command.motion);
+      } else {
+        executeCommand(command);
+        if (mode == Mode::Visual)
+          executeCommandExitToNormalMode();
+      }
+    } else if (status == CommandParser::Status::Pending ||
+               status == CommandParser::Status::Cancelled) {
+      // The rest of the command follows with the next key.
     } else if (key == Qt::Key_Space) {
       waitingForFileLeaderKey = true;
 
     } else {
 
       switch (key) {
-      case Qt::Key_H:
-      case Qt::Key_Left:
-        editorWidget->moveCursor(QTextCursor::Left, QTextCursor::KeepAnchor);
-        break;
-      case Qt::Key_L:
-      case Qt::Key_Right:
-        editorWidget->moveCursor(QTextCursor::Right, QTextCursor::KeepAnchor);
-        break;
-      case Qt::Key_K:
-      case Qt::Key_Up:
-        editorWidget->moveCursor(QTextCursor::Up, QTextCursor::KeepAnchor);
-        break;
-      case Qt::Key_J:
-      case Qt::Key_Down:
-        editorWidget->moveCursor(QTextCursor::Down, QTextCursor::KeepAnchor);
-        break;
-      case Qt::Key_Home:
-        editorWidget->moveCursor(QTextCursor::StartOfLine,
-                                 QTextCursor::KeepAnchor);
-        break;
-      case Qt::Key_End:
-        editorWidget->moveCursor(QTextCursor::EndOfLine,
-                                 QTextCursor::KeepAnchor);
-        break;
-
-      case Qt::Key_PageUp:
-        editorWidget->moveCursor(QTextCursor::StartOfBlock,
-                                 QTextCursor::KeepAnchor);
+      case Qt::Key_PageUp: {
+        QTextCursor cursor = textCursor();
+        cursor.movePosition(QTextCursor::StartOfBlock, QTextCursor::KeepAnchor);
+        setTextCursor(cursor);
         editorWidget->verticalScrollBar()->triggerAction(
             QAbstractSlider::SliderPageStepSub);
         editorWidget->triggerLineNumberUpdate();
         break;
-      case Qt::Key_PageDown:
-        editorWidget->moveCursor(QTextCursor::EndOfBlock,
-                                 QTextCursor::KeepAnchor);
+      }
+      case Qt::Key_PageDown: {
+        QTextCursor cursor = textCursor();
+        cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+        setTextCursor(cursor);
         editorWidget->verticalScrollBar()->triggerAction(
             QAbstractSlider::SliderPageStepAdd);
         editorWidget->triggerLineNumberUpdate();
         break;
+      }
 
       default:
         keyProcessed = false;
@@ -325,74 +386,411 @@ void VimHandler::setMode(Mode newMode) {
   editorWidget->vimSetMode(newMode);
 
   if (oldMode == Mode::Visual && newMode != Mode::Visual) {
-    QTextCursor cursor = editorWidget->textCursor();
+    QTextCursor cursor = textCursor();
     cursor.clearSelection();
-    editorWidget->setTextCursor(cursor);
+    setTextCursor(cursor);
   } else if (newMode == Mode::Visual && oldMode != Mode::Visual &&
-             !editorWidget->textCursor().hasSelection()) {
+             !textCursor().hasSelection()) {
 
-    editorWidget->vimToggleVisualCharacterMode();
+    runOnEditorCursor(&EditorWidget::vimToggleVisualCharacterMode);
   }
 
-  emit modeChanged(mode);
+  // A replay reports the mode it ends in once it is done.
+  if (replayDepth == 0)
+    emit modeChanged(mode);
 }
 
-void VimHandler::processCommandBuffer() {
-  if (commandBuffer == Constants::VIM_CMD_DELETE_LINE) {
-    executeCommandDeleteLine();
-    clearCommandBuffer();
-  } else if (commandBuffer == Constants::VIM_CMD_COPY_LINE) {
-    executeCommandCopyLine();
-    clearCommandBuffer();
-  } else if (commandBuffer.length() >= 2) {
+void VimHandler::clearCommandBuffer() { parser.reset(); }
 
-    clearCommandBuffer();
+void VimHandler::executeCommandUndo() {
+  runOnEditorCursor(&EditorWidget::vimUndo);
+}
+
+void VimHandler::executeCommandEnterInsertMode() {
+  setMode(Mode::Insert);
+  recordChange(Command(), true);
+}
+void VimHandler::executeCommandEnterVisualMode() { setMode(Mode::Visual); }
+
+void VimHandler::executeCommandExitToNormalMode() {
+  if (mode == Mode::Insert && editorWidget) {
+    if (insertStart >= 0) {
+      QTextDocument *document = editorWidget->document();
+      const int end = document->characterCount() - 1;
+      QTextCursor typed(document);
+      typed.setPosition(qMin(insertStart, end));
+      typed.setPosition(qMin(insertEnd, end), QTextCursor::KeepAnchor);
+      lastChange.text = yankedText(typed, false);
+      insertStart = -1;
+      insertEnd = -1;
+    }
+    QTextCursor cursor = textCursor();
+    if (!cursor.atBlockStart()) {
+      cursor.movePosition(QTextCursor::PreviousCharacter);
+    }
+    setTextCursor(cursor);
+  }
+  setMode(Mode::Normal);
+}
+
+// Operators work out the span they cover from the document alone and make
+// their edits in one batch: a single undo step and a single repaint however
+// many lines a count reaches.
+void VimHandler::executeCommand(const Command &command) {
+  if (command.macro != MacroAction::None) {
+    executeMacroCommand(command);
+    return;
+  }
+  if (command.put != Put::None) {
+    if (executePut(command))
+      recordChange(command);
+    return;
   }
+  if (command.repeat) {
+    repeatLastChange(command.motion.count);
+    return;
+  }
+  if (command.op == Operator::None) {
+    executeMotion(command.motion);
+    return;
+  }
+  if (!editorWidget)
+    return;
+  const MotionEngine engine(editorWidget->document());
+  const int position = textCursor().position();
+  const Motion &motion = command.motion;
+  const bool visual = mode == Mode::Visual;
+  TextRange range;
+  if (visual) {
+    const QTextCursor selection = textCursor();
+    range = {selection.selectionStart(), selection.selectionEnd(), false};
+    if (command.lines) {
+      const QTextDocument *document = editorWidget->document();
+      const int first = document->findBlock(range.start).blockNumber();
+      const int last =
+          document->findBlock(qMax(range.start, range.end - 1)).blockNumber();
+      range = engine.lineRange(range.start, last - first + 1);
+    }
+  } else if (command.lines) {
+    range = engine.lineRange(position, motion.count);
+  } else if (command.object.isValid()) {
+    range = engine.objectRange(command.object, position, motion.count);
+  } else if (motion.type == MotionType::WordForward ||
+             motion.type == MotionType::BigWordForward) {
+    range = engine.motionRange(
+        position, engine.operatorWordTarget(motion, position,
+                                            command.op == Operator::Change));
+  } else {
+    int column = -1;
+    range = engine.motionRange(position,
+                               engine.resolve(motion, position, column));
+  }
+  preferredColumn = -1;
+  lastMotionPosition = -1;
+  if (!range.isValid()) {
+    replayFailed = replayDepth > 0;
+    return;
+  }
+  // Visual mode changes depend on the selection and are not repeated.
+  if (applyOperator(command.op, range, command.registerName) &&
+      command.op != Operator::Yank && !visual)
+    recordChange(command);
 }
 
-void VimHandler::clearCommandBuffer() { commandBuffer.clear(); }
+// Returns false when the text could not be changed; the registers are then
+// left as they were.
+bool VimHandler::applyOperator(Operator op, const TextRange &range,
+                               QChar registerName) {
+  if (op != Operator::Yank && editorWidget->editingLocked())
+    return false;
+  QTextDocument *document = editorWidget->document();
+  QTextCursor cursor(document);
+  cursor.setPosition(range.start);
+  cursor.setPosition(range.end, QTextCursor::KeepAnchor);
+  const bool shift = op == Operator::ShiftRight || op == Operator::ShiftLeft;
+  if (!shift && cursor.hasSelection()) {
+    const Register contents{yankedText(cursor, range.linewise),
+                            range.linewise};
+    if (op == Operator::Yank)
+      Registers::instance().yank(registerName, contents);
+    else
+      Registers::instance().remove(registerName, contents);
+  }
+  if (op == Operator::Yank) {
+    const int position = textCursor().position();
+    const bool stay = range.linewise && document->findBlock(position) ==
+                                            document->findBlock(range.start);
+    cursor.setPosition(stay ? position : range.start);
+    setTextCursor(cursor);
+    return true;
+  }
 
-void VimHandler::executeCommandDeleteLine() {
-  if (editorWidget)
-    editorWidget->vimDeleteLine();
+  const MotionEngine engine(document);
+  const Motion firstNonBlank{MotionType::FirstNonBlank, 0, QChar()};
+  int column = -1;
+  editorWidget->beginBatchEdit();
+  if (shift) {
+    shiftLines(document->findBlock(range.start),
+               document->findBlock(qMax(range.start, range.end - 1)),
+               op == Operator::ShiftRight);
+    cursor.setPosition(
+        engine.resolve(firstNonBlank, range.start, column).position);
+  } else if (range.linewise) {
+    // cc keeps an empty line to type into; dd on the last line takes the
+    // line break before it instead of the one after.
+    const bool endsInBreak =
+        range.end > range.start &&
+        document->characterAt(range.end - 1) == QChar::ParagraphSeparator;
+    if (op == Operator::Change && endsInBreak) {
+      cursor.setPosition(range.start);
+      cursor.setPosition(range.end - 1, QTextCursor::KeepAnchor);
+    } else if (op == Operator::Delete && !endsInBreak && range.start > 0) {
+      cursor.setPosition(range.start - 1);
+      cursor.setPosition(range.end, QTextCursor::KeepAnchor);
+    }
+    cursor.removeSelectedText();
+    if (op == Operator::Delete)
+      cursor.setPosition(
+          engine.resolve(firstNonBlank, cursor.position(), column).position);
+  } else {
+    cursor.removeSelectedText();
+    if (op == Operator::Delete)
+      cursor.setPosition(engine.clampToCharacter(cursor.position()));
+  }
+  setTextCursor(cursor);
+  editorWidget->endBatchEdit();
+  if (op == Operator::Change)
+    setMode(Mode::Insert);
+  return true;
 }
-void VimHandler::executeCommandCopyLine() {
-  if (editorWidget)
-    editorWidget->vimCopyLine();
+
+// p puts the register after the cursor, or below its line when it holds
+// whole lines, and P before or above. A count repeats the text, which is
+// inserted as one edit. Returns false when nothing was put.
+bool VimHandler::executePut(const Command &command) {
+  if (!editorWidget || editorWidget->editingLocked())
+    return false;
+  const Register contents = Registers::instance().get(command.registerName);
+  if (contents.isEmpty())
+    return false;
+  const QString text = contents.text.repeated(qMax(1, command.motion.count));
+  const bool after = command.put == Put::After;
+  QTextCursor cursor = textCursor();
+  cursor.clearSelection();
+  const QTextBlock block = cursor.block();
+  const int lineEnd = block.position() + block.length() - 1;
+  int start = cursor.position();
+  editorWidget->beginBatchEdit();
+  if (!contents.linewise) {
+    if (after && start < lineEnd)
+      ++start;
+    cursor.setPosition(start);
+    cursor.insertText(text);
+    if (!text.contains(QLatin1Char('\n')))
+      start += text.size() - 1;
+  } else if (after && !block.next().isValid()) {
+    // Below the last line: the text's final line break goes before it.
+    cursor.setPosition(lineEnd);
+    cursor.insertText(QLatin1Char('\n') + text.chopped(1));
+    start = lineEnd + 1;
+  } else {
+    start = after ? block.next().position() : block.position();
+    cursor.setPosition(start);
+    cursor.insertText(text);
+  }
+  if (contents.linewise) {
+    const MotionEngine engine(editorWidget->document());
+    const Motion firstNonBlank{MotionType::FirstNonBlank, 0, QChar()};
+    int column = -1;
+    start = engine.resolve(firstNonBlank, start, column).position;
+  }
+  cursor.setPosition(start);
+  setTextCursor(cursor);
+  editorWidget->endBatchEdit();
+  return true;
 }
-void VimHandler::executeCommandCutSelection() {
-  if (editorWidget)
-    editorWidget->vimCutSelection();
+
+// `.` applies the last change again at the cursor from its recorded
+// command and text, without going through the keys that made it. A count
+// replaces the one the change was made with, or repeats a plain insert;
+// either way the result is a single edit.
+void VimHandler::repeatLastChange(int count) {
+  if (!hasLastChange || !editorWidget || editorWidget->editingLocked())
+    return;
+  Command command = lastChange.command;
+  if (count > 0)
+    command.motion.count = count;
+  repeatingChange = true;
+  editorWidget->beginBatchEdit();
+  if (lastChange.insert)
+    setMode(Mode::Insert);
+  else
+    executeCommand(command);
+  if (mode == Mode::Insert) {
+    QTextCursor cursor = textCursor();
+    cursor.insertText(lastChange.insert
+                          ? lastChange.text.repeated(qMax(1, count))
+                          : lastChange.text);
+    setTextCursor(cursor);
+    executeCommandExitToNormalMode();
+  }
+  editorWidget->endBatchEdit();
+  repeatingChange = false;
+  // A new count is kept for the next repeat, as in Vim.
+  if (!lastChange.insert)
+    lastChange.command = command;
 }
-void VimHandler::executeCommandCopySelection() {
-  if (editorWidget)
-    editorWidget->vimCopySelection();
+
+// Changes that end in Insert mode take the text typed there along when
+// Insert mode is left.
+void VimHandler::recordChange(const Command &command, bool insert) {
+  if (repeatingChange)
+    return;
+  lastChange = {command, insert, QString()};
+  hasLastChange = true;
+  insertStart = mode == Mode::Insert ? textCursor().position() : -1;
+  insertEnd = insertStart;
 }
-void VimHandler::executeCommandPaste() {
-  if (editorWidget)
-    editorWidget->vimPasteText();
+
+// Follows what is actually typed for the last change rather than where the
+// cursor ends up, so moving around in Insert mode records nothing. Edits
+// within the run extend or shrink it; an edit elsewhere, after the cursor
+// was moved away, starts a new run there, like a new insert does in Vim.
+void VimHandler::trackInsertedText(int position, int charsRemoved,
+                                   int charsAdded) {
+  if (insertStart < 0)
+    return;
+  if (position >= insertStart && position + charsRemoved <= insertEnd) {
+    insertEnd += charsAdded - charsRemoved;
+  } else {
+    insertStart = position;
+    insertEnd = position + charsAdded;
+  }
 }
-void VimHandler::executeCommandUndo() {
-  if (editorWidget)
-    editorWidget->vimUndo();
+
+// Motions scan the document directly instead of stepping a QTextCursor,
+// so large counts cost one pass over the text they cross.
+void VimHandler::executeMotion(const Motion &motion) {
+  if (!editorWidget)
+    return;
+  QTextCursor cursor = textCursor();
+  if (cursor.position() != lastMotionPosition)
+    preferredColumn = -1;
+  const MotionEngine engine(editorWidget->document());
+  const MotionTarget target =
+      engine.resolve(motion, cursor.position(), preferredColumn);
+  if (!target.isValid()) {
+    replayFailed = replayDepth > 0;
+    return;
+  }
+  lastMotionPosition = engine.clampToCharacter(target.position);
+  cursor.setPosition(lastMotionPosition);
+  setTextCursor(cursor);
 }
-void VimHandler::executeCommandCutChar() {
-  if (editorWidget)
-    editorWidget->vimCutChar();
+
+// The visual selection includes the characters under both its ends, while
+// a QTextCursor selection stops before its position. The Vim cursor is the
+// last selected character when selecting forward and the first otherwise.
+void VimHandler::moveVisualCursor(const Motion &motion) {
+  if (!editorWidget)
+    return;
+  QTextCursor cursor = textCursor();
+  int anchor = cursor.anchor();
+  int position = cursor.position();
+  if (position > anchor)
+    --position;
+  else if (position < anchor)
+    --anchor;
+  if (position != lastMotionPosition)
+    preferredColumn = -1;
+  const MotionEngine engine(editorWidget->document());
+  const MotionTarget target =
+      engine.resolve(motion, position, preferredColumn);
+  if (!target.isValid()) {
+    replayFailed = replayDepth > 0;
+    return;
+  }
+  position = engine.clampToCharacter(target.position);
+  lastMotionPosition = position;
+  const int end = editorWidget->document()->characterCount() - 1;
+  if (position >= anchor) {
+    cursor.setPosition(anchor);
+    cursor.setPosition(qMin(position + 1, end), QTextCursor::KeepAnchor);
+  } else {
+    cursor.setPosition(qMin(anchor + 1, end));
+    cursor.setPosition(position, QTextCursor::KeepAnchor);
+  }
+  setTextCursor(cursor);
 }
 
-void VimHandler::executeCommandEnterInsertMode() { setMode(Mode::Insert); }
-void VimHandler::executeCommandEnterVisualMode() { setMode(Mode::Visual); }
+void VimHandler::executeMacroCommand(const Command &command) {
+  if (!editorWidget)
+    return;
+  const QChar name = command.registerName;
+  if (command.macro == MacroAction::Record) {
+    recordingRegister = name;
+    recordedKeys.clear();
+    return;
+  }
+  const QChar replayed = name == QLatin1Char('@') ? lastMacro : name.toLower();
+  if (!replayed.isNull())
+    replayMacro(replayed, qMax(1, command.motion.count));
+}
 
-void VimHandler::executeCommandExitToNormalMode() {
-  if (mode == Mode::Insert && editorWidget) {
-    QTextCursor cursor = editorWidget->textCursor();
-    if (!cursor.atBlockStart()) {
-      cursor.movePosition(QTextCursor::PreviousCharacter);
+// Replays go through the same parser and commands as typed keys, but with
+// the cursor kept here and every edit inside one batch on the editor: the
+// whole replay is a single undo step, and repainting, the gutter and
+// highlighting catch up once at the end instead of after every key. Like
+// in Vim, a motion or command that fails ends the replay.
+void VimHandler::replayMacro(QChar name, int count) {
+  if (replayDepth >= Constants::VIM_MAX_MACRO_DEPTH)
+    return;
+  const QVector<KeyStroke> strokes =
+      KeyStroke::fromText(Registers::instance().get(name).text);
+  if (strokes.isEmpty())
+    return;
+  lastMacro = name;
+  if (replayDepth == 0) {
+    replayCursor = editorWidget->textCursor();
+    replayFailed = false;
+    editorWidget->beginBatchEdit();
+  }
+  ++replayDepth;
+  for (int i = 0; i < count && !replayFailed; ++i) {
+    for (const KeyStroke &stroke : strokes) {
+      handleKeyStroke(stroke);
+      if (replayFailed)
+        break;
     }
-    editorWidget->setTextCursor(cursor);
   }
-  setMode(Mode::Normal);
+  if (--replayDepth > 0)
+    return;
+  editorWidget->setTextCursor(replayCursor);
+  editorWidget->endBatchEdit();
+  emit modeChanged(mode);
+}
+
+// The cursor commands work on: the editor's, or during a replay one kept
+// here so that moving it does not notify the editor every time.
+QTextCursor VimHandler::textCursor() const {
+  return replayDepth > 0 ? replayCursor : editorWidget->textCursor();
+}
+
+void VimHandler::setTextCursor(const QTextCursor &cursor) {
+  if (replayDepth > 0)
+    replayCursor = cursor;
+  else
+    editorWidget->setTextCursor(cursor);
+}
+
+void VimHandler::runOnEditorCursor(void (EditorWidget::*command)()) {
+  if (!editorWidget)
+    return;
+  if (replayDepth > 0)
+    editorWidget->setTextCursor(replayCursor);
+  (editorWidget->*command)();
+  if (replayDepth > 0)
+    replayCursor = editorWidget->textCursor();
 }
 
 void VimHandler::executeCommandSaveFile() { emit saveFileRequested(); }
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "editor/vim/vim_modes.hpp"
+#include "editor/vim/vim_parser.hpp"
 
+#include <QChar>
 #include <QObject>
 #include <QString>
+#include <QTextCursor>
 
 class QKeyEvent;
 class EditorWidget;
@@ -25,30 +28,65 @@ signals:
   void saveFileAsRequested();
 
 private:
+  bool handleKeyStroke(const KeyStroke &stroke);
   void setMode(Mode newMode);
-  void processNormalModeKey(QKeyEvent *event);
-  void processVisualModeKey(QKeyEvent *event);
-  void processInsertModeKey(QKeyEvent *event);
-  void processCommandBuffer();
+  void processNormalModeKey(const KeyStroke &stroke);
+  void processVisualModeKey(const KeyStroke &stroke);
+  void processInsertModeKey(const KeyStroke &stroke);
   void clearCommandBuffer();
   void resetLeaderState();
 
-  void executeCommandDeleteLine();
-  void executeCommandCopyLine();
-  void executeCommandCutSelection();
-  void executeCommandCopySelection();
-  void executeCommandPaste();
   void executeCommandUndo();
-  void executeCommandCutChar();
   void executeCommandEnterInsertMode();
   void executeCommandEnterVisualMode();
   void executeCommandExitToNormalMode();
   void executeCommandSaveFile();
   void executeCommandSaveFileAs();
+  void executeCommand(const Command &command);
+  void executeMotion(const Motion &motion);
+  bool applyOperator(Operator op, const TextRange &range, QChar registerName);
+  bool executePut(const Command &command);
+  void repeatLastChange(int count);
+  void recordChange(const Command &command, bool insert = false);
+  void trackInsertedText(int position, int charsRemoved, int charsAdded);
+  void executeMacroCommand(const Command &command);
+  void replayMacro(QChar name, int count);
+
+  QTextCursor textCursor() const;
+  void setTextCursor(const QTextCursor &cursor);
+  void runOnEditorCursor(void (EditorWidget::*command)());
+  void moveVisualCursor(const Motion &motion);
 
   EditorWidget *editorWidget;
   Mode mode = Mode::Insert;
-  QString commandBuffer;
+  CommandParser parser;
+  // Column j and k aim for, kept while the cursor only moves vertically.
+  int preferredColumn = -1;
+  int lastMotionPosition = -1;
+
+  // The last change, for `.`: the command that made it, or a plain insert,
+  // and the text typed in Insert mode after it.
+  struct Change {
+    Command command;
+    bool insert = false;
+    QString text;
+  };
+  Change lastChange;
+  bool hasLastChange = false;
+  bool repeatingChange = false;
+  // The run of text typed for the last change, [insertStart, insertEnd),
+  // while it is typed; -1 outside Insert mode.
+  int insertStart = -1;
+  int insertEnd = -1;
+
+  // Keys typed since q{register}, stored in the register once q ends the
+  // recording.
+  QChar recordingRegister;
+  QString recordedKeys;
+  QChar lastMacro;
+  int replayDepth = 0;
+  bool replayFailed = false;
+  QTextCursor replayCursor;
 
   bool waitingForFileLeaderKey = false;
   bool waitingForFileSaveKey = false;
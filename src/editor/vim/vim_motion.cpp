@@ -0,0 +1,667 @@
+#include "editor/vim/vim_motion.hpp"
+
+#include <QTextDocument>
+
+#include <array>
+#include <climits>
+
+namespace Jino::Editor::Vim {
+
+namespace {
+constexpr std::array<CharClass, 128> ASCII_CLASSES = [] {
+  std::array<CharClass, 128> classes{};
+  for (int c = 0; c < 128; ++c) {
+    if (c == ' ' || (c >= '\t' && c <= '\r'))
+      classes[c] = Blank;
+    else if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') ||
+             (c >= 'a' && c <= 'z') || c == '_')
+      classes[c] = WordChar;
+    else
+      classes[c] = Punctuation;
+  }
+  return classes;
+}();
+
+int blockEnd(const QTextBlock &block) {
+  return block.position() + block.length() - 1;
+}
+
+bool isEmptyLine(const QTextBlock &block) { return block.length() == 1; }
+
+// Both halves of a bracket pair, the opening one first.
+bool bracketPair(QChar c, QChar &open, QChar &close) {
+  switch (c.unicode()) {
+  case '(':
+  case ')':
+    open = QLatin1Char('(');
+    close = QLatin1Char(')');
+    return true;
+  case '[':
+  case ']':
+    open = QLatin1Char('[');
+    close = QLatin1Char(']');
+    return true;
+  case '{':
+  case '}':
+    open = QLatin1Char('{');
+    close = QLatin1Char('}');
+    return true;
+  default:
+    return false;
+  }
+}
+} // namespace
+
+TextIterator::TextIterator(const QTextDocument *document, int position) {
+  const QTextBlock block = document->findBlock(position);
+  load(block.isValid() ? block : document->lastBlock());
+  setColumn(position - blockStart);
+}
+
+void TextIterator::load(const QTextBlock &block) {
+  currentBlock = block;
+  text = block.text();
+  blockStart = block.position();
+}
+
+CharClass charClass(QChar c, bool bigWord) {
+  const ushort code = c.unicode();
+  CharClass result;
+  if (code < 128)
+    result = ASCII_CLASSES[code];
+  else if (c.isSpace())
+    result = Blank;
+  else if (c.isLetterOrNumber() || c.isMark() || c.isSurrogate())
+    result = WordChar;
+  else
+    result = Punctuation;
+  return bigWord && result != Blank ? WordChar : result;
+}
+
+MotionEngine::MotionEngine(const QTextDocument *document)
+    : document(document) {}
+
+MotionTarget MotionEngine::resolve(const Motion &motion, int position,
+                                   int &preferredColumn) const {
+  const int count = qMax(1, motion.count);
+  switch (motion.type) {
+  case MotionType::Up:
+  case MotionType::Down:
+  case MotionType::FirstLine:
+  case MotionType::LastLine:
+    return vertical(motion, position, preferredColumn);
+  case MotionType::LineEnd: {
+    const MotionTarget target = horizontal(motion, position);
+    if (target.isValid())
+      preferredColumn = INT_MAX;
+    return target;
+  }
+  default:
+    break;
+  }
+  preferredColumn = -1;
+  switch (motion.type) {
+  case MotionType::WordForward:
+  case MotionType::BigWordForward:
+    return wordForward(position, count,
+                       motion.type == MotionType::BigWordForward);
+  case MotionType::WordBackward:
+  case MotionType::BigWordBackward:
+    return wordBackward(position, count,
+                        motion.type == MotionType::BigWordBackward);
+  case MotionType::WordEnd:
+  case MotionType::BigWordEnd:
+    return wordEnd(position, count, motion.type == MotionType::BigWordEnd);
+  case MotionType::MatchPair:
+    if (motion.count > 0) {
+      // N% goes to the line N percent into the file.
+      if (motion.count > 100)
+        return MotionTarget();
+      const int line = (motion.count * lineCount() + 99) / 100 - 1;
+      const QTextBlock block = document->findBlockByNumber(line);
+      return {firstNonBlank(block), MotionRange::Linewise};
+    }
+    return matchPair(position);
+  case MotionType::ParagraphForward:
+  case MotionType::ParagraphBackward:
+    return paragraph(position, count,
+                     motion.type == MotionType::ParagraphForward);
+  case MotionType::FindForward:
+  case MotionType::TillForward:
+  case MotionType::FindBackward:
+  case MotionType::TillBackward:
+    return find(motion, position);
+  case MotionType::None:
+    return MotionTarget();
+  default:
+    return horizontal(motion, position);
+  }
+}
+
+// Where the cursor rests after moving to `position` in Normal mode.
+int MotionEngine::clampToCharacter(int position) const {
+  const QTextBlock block = document->findBlock(position);
+  if (block.isValid() && !isEmptyLine(block) && position >= blockEnd(block))
+    return blockEnd(block) - 1;
+  return position;
+}
+
+int MotionEngine::lineCount() const { return document->blockCount(); }
+
+int MotionEngine::lineTarget(int line, int column) const {
+  const QTextBlock block = document->findBlockByNumber(line);
+  const int last = qMax(0, block.length() - 2);
+  return block.position() + qMin(column, last);
+}
+
+int MotionEngine::firstNonBlank(const QTextBlock &block) const {
+  const QString text = block.text();
+  int column = 0;
+  while (column < text.size() && (text.at(column) == QLatin1Char(' ') ||
+                                  text.at(column) == QLatin1Char('\t')))
+    ++column;
+  return block.position() + qMin(column, qMax(0, text.size() - 1));
+}
+
+MotionTarget MotionEngine::horizontal(const Motion &motion,
+                                      int position) const {
+  const QTextBlock block = document->findBlock(position);
+  const int column = position - block.position();
+  const int length = block.length() - 1;
+  const int count = qMax(1, motion.count);
+  switch (motion.type) {
+  case MotionType::Left:
+    if (column == 0)
+      return MotionTarget();
+    return {block.position() + qMax(0, column - count),
+            MotionRange::Exclusive};
+  case MotionType::Right:
+    if (column >= length)
+      return MotionTarget();
+    return {block.position() + qMin(length, column + count),
+            MotionRange::Exclusive};
+  case MotionType::LineStart:
+    return {block.position(), MotionRange::Exclusive};
+  case MotionType::FirstNonBlank:
+    return {firstNonBlank(block), MotionRange::Exclusive};
+  case MotionType::LineEnd: {
+    const int line = block.blockNumber() + count - 1;
+    if (line >= lineCount())
+      return MotionTarget();
+    const QTextBlock target =
+        count == 1 ? block : document->findBlockByNumber(line);
+    return {isEmptyLine(target) ? target.position() : blockEnd(target) - 1,
+            MotionRange::Inclusive};
+  }
+  default:
+    return MotionTarget();
+  }
+}
+
+MotionTarget MotionEngine::vertical(const Motion &motion, int position,
+                                    int &preferredColumn) const {
+  const QTextBlock block = document->findBlock(position);
+  const int line = block.blockNumber();
+  const int last = lineCount() - 1;
+  switch (motion.type) {
+  case MotionType::FirstLine:
+  case MotionType::LastLine: {
+    preferredColumn = -1;
+    int target = motion.type == MotionType::FirstLine ? 0 : last;
+    if (motion.count > 0)
+      target = qMin(motion.count - 1, last);
+    return {firstNonBlank(document->findBlockByNumber(target)),
+            MotionRange::Linewise};
+  }
+  default: {
+    const int count = qMax(1, motion.count);
+    const int target = qBound(
+        0, motion.type == MotionType::Down ? line + count : line - count,
+        last);
+    if (target == line)
+      return MotionTarget();
+    if (preferredColumn < 0)
+      preferredColumn = position - block.position();
+    return {lineTarget(target, preferredColumn), MotionRange::Linewise};
+  }
+  }
+}
+
+// The word motions follow Vim's fwd_word(), bck_word() and end_word(): line
+// ends count as blanks and an empty line is a word of its own. Running into
+// either end of the document stops the motion there.
+MotionTarget MotionEngine::wordForward(int position, int count,
+                                       bool bigWord,
+                                       bool stopAtLineEnd) const {
+  TextIterator it(document, position);
+  const auto cls = [&]() { return charClass(it.character(), bigWord); };
+  for (int i = 0; i < count; ++i) {
+    // On the last word an operator stops at the end of its line.
+    const bool lastStep = stopAtLineEnd && i == count - 1;
+    const auto step = [&]() {
+      return it.next() && !(lastStep && it.atLineEnd());
+    };
+    const CharClass start = cls();
+    if (!step())
+      break;
+    bool stopped = false;
+    if (start != Blank) {
+      while (cls() == start && !stopped)
+        stopped = !step();
+    }
+    while (cls() == Blank && !stopped) {
+      if (it.atLineStart() && it.lineEmpty())
+        break;
+      stopped = !step();
+    }
+    if (stopped)
+      break;
+  }
+  if (it.position() == position)
+    return MotionTarget();
+  return {it.position(), MotionRange::Exclusive};
+}
+
+MotionTarget MotionEngine::wordBackward(int position, int count,
+                                        bool bigWord) const {
+  TextIterator it(document, position);
+  const auto cls = [&]() { return charClass(it.character(), bigWord); };
+  for (int i = 0; i < count; ++i) {
+    if (!it.previous())
+      break;
+    bool emptyLine = false;
+    bool atStart = false;
+    while (cls() == Blank) {
+      if (it.atLineStart() && it.lineEmpty()) {
+        emptyLine = true;
+        break;
+      }
+      if (!it.previous()) {
+        atStart = true;
+        break;
+      }
+    }
+    if (emptyLine)
+      continue;
+    if (atStart)
+      break;
+    const CharClass word = cls();
+    while (cls() == word) {
+      if (!it.previous()) {
+        atStart = true;
+        break;
+      }
+    }
+    if (atStart)
+      break;
+    it.next();
+  }
+  if (it.position() == position)
+    return MotionTarget();
+  return {it.position(), MotionRange::Exclusive};
+}
+
+MotionTarget MotionEngine::wordEnd(int position, int count, bool bigWord,
+                                   bool stopAtWordEnd) const {
+  TextIterator it(document, position);
+  const auto cls = [&]() { return charClass(it.character(), bigWord); };
+  bool atEnd = false;
+  for (int i = 0; i < count && !atEnd; ++i) {
+    const CharClass start = cls();
+    if (!it.next())
+      break;
+    // cw on the last character of a word changes just that character.
+    if (stopAtWordEnd && i == 0 && start != Blank && cls() != start) {
+      it.previous();
+      continue;
+    }
+    if (cls() != start || start == Blank) {
+      while (cls() == Blank && !atEnd)
+        atEnd = !it.next();
+    }
+    const CharClass word = cls();
+    while (cls() == word && !atEnd)
+      atEnd = !it.next();
+    if (!atEnd)
+      it.previous();
+  }
+  if (it.position() == position && !stopAtWordEnd)
+    return MotionTarget();
+  return {it.position(), MotionRange::Inclusive};
+}
+
+// Without a count, % looks for the first bracket at or after the cursor on
+// the line and jumps to its partner, counting nested pairs on the way.
+MotionTarget MotionEngine::matchPair(int position) const {
+  TextIterator it(document, position);
+  QChar open;
+  QChar close;
+  while (!bracketPair(it.character(), open, close)) {
+    if (it.atLineEnd())
+      return MotionTarget();
+    it.next();
+  }
+  const QChar bracket = it.character();
+  const QChar partner = bracket == open ? close : open;
+  const bool forward = bracket == open;
+  int depth = 0;
+  do {
+    const QChar c = it.character();
+    if (c == bracket) {
+      ++depth;
+    } else if (c == partner && --depth == 0) {
+      return {it.position(), MotionRange::Inclusive};
+    }
+  } while (forward ? it.next() : it.previous());
+  return MotionTarget();
+}
+
+// Like Vim's findpar(): paragraphs are separated by empty lines. Asking for
+// more paragraphs than there are fails; reaching the last line puts the
+// cursor on its last character.
+MotionTarget MotionEngine::paragraph(int position, int count,
+                                     bool forward) const {
+  QTextBlock block = document->findBlock(position);
+  for (int remaining = count; remaining > 0; --remaining) {
+    bool skipped = false;
+    for (bool first = true;; first = false) {
+      if (!isEmptyLine(block))
+        skipped = true;
+      if (!first && skipped && isEmptyLine(block))
+        break;
+      const QTextBlock following = forward ? block.next() : block.previous();
+      if (!following.isValid()) {
+        if (remaining > 1)
+          return MotionTarget();
+        break;
+      }
+      block = following;
+    }
+  }
+  if (!block.next().isValid() && !isEmptyLine(block))
+    return {blockEnd(block) - 1, MotionRange::Inclusive};
+  if (block.position() == position)
+    return MotionTarget();
+  return {block.position(), MotionRange::Exclusive};
+}
+
+MotionTarget MotionEngine::find(const Motion &motion, int position) const {
+  const QTextBlock block = document->findBlock(position);
+  const QString text = block.text();
+  int column = position - block.position();
+  const bool forward = motion.type == MotionType::FindForward ||
+                       motion.type == MotionType::TillForward;
+  for (int i = 0; i < qMax(1, motion.count); ++i) {
+    column = forward ? text.indexOf(motion.argument, column + 1)
+                     : (column > 0 ? text.lastIndexOf(motion.argument,
+                                                      column - 1)
+                                   : -1);
+    if (column < 0)
+      return MotionTarget();
+  }
+  switch (motion.type) {
+  case MotionType::TillForward:
+    --column;
+    break;
+  case MotionType::TillBackward:
+    ++column;
+    break;
+  default:
+    break;
+  }
+  return {block.position() + column,
+          forward ? MotionRange::Inclusive : MotionRange::Exclusive};
+}
+
+// Vim's rules for exclusive motions that end in column 0 of a later line:
+// the span stops at the end of the line before, and becomes linewise when
+// nothing but blanks precede its start (dw on the last word of a line
+// followed by an indented one, d} from the start of a paragraph).
+TextRange MotionEngine::motionRange(int position,
+                                    const MotionTarget &target) const {
+  if (!target.isValid())
+    return TextRange();
+  const int start = qMin(position, target.position);
+  int end = qMax(position, target.position);
+  const QTextBlock startBlock = document->findBlock(start);
+  const QTextBlock endBlock = document->findBlock(end);
+  switch (target.range) {
+  case MotionRange::Linewise:
+    return lines(startBlock, endBlock);
+  case MotionRange::Inclusive:
+    if (end < blockEnd(endBlock))
+      ++end;
+    return {start, end, false};
+  case MotionRange::Exclusive:
+    break;
+  }
+  if (endBlock != startBlock && end == endBlock.position()) {
+    if (start <= firstNonBlank(startBlock))
+      return lines(startBlock, endBlock.previous());
+    end = blockEnd(endBlock.previous());
+  }
+  return {start, end, false};
+}
+
+TextRange MotionEngine::lineRange(int position, int count) const {
+  const QTextBlock first = document->findBlock(position);
+  const int last =
+      qMin(first.blockNumber() + qMax(1, count) - 1, lineCount() - 1);
+  return lines(first, document->findBlockByNumber(last));
+}
+
+TextRange MotionEngine::objectRange(const TextObject &object, int position,
+                                    int count) const {
+  count = qMax(1, count);
+  const bool inner = object.inner;
+  switch (object.kind.unicode()) {
+  case 'w':
+  case 'W':
+    return wordObject(position, count, inner,
+                      object.kind == QLatin1Char('W'));
+  case 'p':
+    return paragraphObject(position, count, inner);
+  case '(':
+  case ')':
+  case 'b':
+    return bracketObject(position, count, inner, QLatin1Char('('),
+                         QLatin1Char(')'));
+  case '[':
+  case ']':
+    return bracketObject(position, count, inner, QLatin1Char('['),
+                         QLatin1Char(']'));
+  case '{':
+  case '}':
+  case 'B':
+    return bracketObject(position, count, inner, QLatin1Char('{'),
+                         QLatin1Char('}'));
+  case '<':
+  case '>':
+    return bracketObject(position, count, inner, QLatin1Char('<'),
+                         QLatin1Char('>'));
+  case '"':
+  case '\'':
+  case '`':
+    return quoteObject(position, inner, object.kind);
+  default:
+    return TextRange();
+  }
+}
+
+MotionTarget MotionEngine::operatorWordTarget(const Motion &motion,
+                                              int position,
+                                              bool change) const {
+  const bool bigWord = motion.type == MotionType::BigWordForward;
+  const int count = qMax(1, motion.count);
+  const TextIterator it(document, position);
+  if (change && charClass(it.character(), bigWord) != Blank)
+    return wordEnd(position, count, bigWord, true);
+  return wordForward(position, count, bigWord, true);
+}
+
+TextRange MotionEngine::lines(const QTextBlock &first,
+                              const QTextBlock &last) const {
+  const QTextBlock following = last.next();
+  return {first.position(),
+          following.isValid() ? following.position() : blockEnd(last), true};
+}
+
+// iw covers count runs of one class (words and the blanks between them)
+// within the line. aw takes a word with the blanks after it, or before it
+// when there are none, and on blanks the blanks with the word after them.
+TextRange MotionEngine::wordObject(int position, int count, bool inner,
+                                   bool bigWord) const {
+  const QTextBlock block = document->findBlock(position);
+  const QString text = block.text();
+  if (text.isEmpty())
+    return TextRange();
+  const auto cls = [&](int column) {
+    return charClass(text.at(column), bigWord);
+  };
+  const auto runEnd = [&](int column) {
+    const CharClass run = cls(column);
+    while (column < text.size() && cls(column) == run)
+      ++column;
+    return column;
+  };
+  const int column = qMin(position - block.position(), text.size() - 1);
+  const bool onBlank = cls(column) == Blank;
+  int start = column;
+  while (start > 0 && cls(start - 1) == cls(column))
+    --start;
+  int end = runEnd(column);
+  if (inner) {
+    for (int i = 1; i < count && end < text.size(); ++i)
+      end = runEnd(end);
+  } else {
+    for (int i = 0; i < count && end < text.size(); ++i) {
+      if (i > 0)
+        end = runEnd(end);
+      if (end < text.size() && (onBlank || cls(end) == Blank))
+        end = runEnd(end);
+    }
+    if (!onBlank && cls(end - 1) != Blank) {
+      while (start > 0 && cls(start - 1) == Blank)
+        --start;
+    }
+  }
+  return {block.position() + start, block.position() + end, false};
+}
+
+// Paragraph objects count runs of empty and of non-empty lines alike; ap
+// adds the empty lines after the paragraph, or those before it when the
+// paragraph ends the document.
+TextRange MotionEngine::paragraphObject(int position, int count,
+                                        bool inner) const {
+  const auto runLast = [](QTextBlock block) {
+    const bool empty = isEmptyLine(block);
+    while (block.next().isValid() && isEmptyLine(block.next()) == empty)
+      block = block.next();
+    return block;
+  };
+  QTextBlock first = document->findBlock(position);
+  const bool onEmpty = isEmptyLine(first);
+  while (first.previous().isValid() &&
+         isEmptyLine(first.previous()) == onEmpty)
+    first = first.previous();
+  QTextBlock last = runLast(first);
+  const int runs = inner ? count : 2 * count;
+  for (int i = 1; i < runs && last.next().isValid(); ++i)
+    last = runLast(last.next());
+  if (!inner && !onEmpty && !isEmptyLine(last)) {
+    while (first.previous().isValid() && isEmptyLine(first.previous()))
+      first = first.previous();
+  }
+  return lines(first, last);
+}
+
+// Looks back for the count-th bracket that encloses the cursor, a bracket
+// under the cursor included, and forward for its partner. The inner object
+// leaves out a line break after the opening bracket and the indentation
+// before a closing bracket on a line of its own.
+TextRange MotionEngine::bracketObject(int position, int count, bool inner,
+                                      QChar open, QChar close) const {
+  TextIterator it(document, position);
+  int depth = 0;
+  for (bool atCursor = true;; atCursor = false) {
+    const QChar c = it.character();
+    if (c == close && !atCursor) {
+      ++depth;
+    } else if (c == open) {
+      if (depth == 0 && --count == 0)
+        break;
+      depth = qMax(0, depth - 1);
+    }
+    if (!it.previous())
+      return TextRange();
+  }
+  const int openPosition = it.position();
+  int closePosition = -1;
+  depth = 0;
+  do {
+    const QChar c = it.character();
+    if (c == open) {
+      ++depth;
+    } else if (c == close && --depth == 0) {
+      closePosition = it.position();
+      break;
+    }
+  } while (it.next());
+  if (closePosition < 0)
+    return TextRange();
+  if (!inner)
+    return {openPosition, closePosition + 1, false};
+
+  int start = openPosition + 1;
+  if (start == blockEnd(document->findBlock(openPosition)))
+    ++start;
+  int end = closePosition;
+  const QTextBlock closeBlock = document->findBlock(closePosition);
+  const QString indent =
+      closeBlock.text().left(closePosition - closeBlock.position());
+  if (closeBlock.position() >= start && indent.trimmed().isEmpty())
+    end = closeBlock.position();
+  return {start, qMax(start, end), false};
+}
+
+// Quotes pair up from the start of the line, skipping escaped ones; the
+// first pair that ends at or after the cursor is used. The outer object
+// takes the blanks after the closing quote, or before the opening one.
+TextRange MotionEngine::quoteObject(int position, bool inner,
+                                   QChar quote) const {
+  const QTextBlock block = document->findBlock(position);
+  const QString text = block.text();
+  const int column = position - block.position();
+  int open = -1;
+  int close = -1;
+  for (int i = 0; i < text.size() && close < 0; ++i) {
+    if (text.at(i) == QLatin1Char('\\')) {
+      ++i;
+    } else if (text.at(i) == quote) {
+      if (open < 0)
+        open = i;
+      else if (i >= column)
+        close = i;
+      else
+        open = -1;
+    }
+  }
+  if (close < 0)
+    return TextRange();
+  if (inner)
+    return {block.position() + open + 1, block.position() + close, false};
+  const auto isBlank = [&](int i) {
+    return text.at(i) == QLatin1Char(' ') || text.at(i) == QLatin1Char('\t');
+  };
+  int start = open;
+  int end = close + 1;
+  while (end < text.size() && isBlank(end))
+    ++end;
+  if (end == close + 1) {
+    while (start > 0 && isBlank(start - 1))
+      --start;
+  }
+  return {block.position() + start, block.position() + end, false};
+}
+
+} // namespace Jino::Editor::Vim
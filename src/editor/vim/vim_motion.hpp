@@ -0,0 +1,188 @@
+// src/editor/vim/vim_motion.hpp
+#pragma once
+
+#include <QChar>
+#include <QString>
+#include <QTextBlock>
+
+class QTextDocument;
+
+namespace Jino::Editor::Vim {
+
+enum class MotionType {
+  None,
+  Left,
+  Right,
+  Up,
+  Down,
+  LineStart,
+  FirstNonBlank,
+  LineEnd,
+  WordForward,
+  WordBackward,
+  WordEnd,
+  BigWordForward,
+  BigWordBackward,
+  BigWordEnd,
+  FirstLine,
+  LastLine,
+  MatchPair,
+  ParagraphForward,
+  ParagraphBackward,
+  FindForward,
+  TillForward,
+  FindBackward,
+  TillBackward,
+};
+
+// A motion as typed: the count is 0 when none was given, the argument is
+// the character f, t, F and T look for.
+struct Motion {
+  MotionType type = MotionType::None;
+  int count = 0;
+  QChar argument;
+};
+
+// How much of the text between the cursor and the target an operator
+// covers: up to the target, including it, or whole lines.
+enum class MotionRange { Exclusive, Inclusive, Linewise };
+
+struct MotionTarget {
+  int position = -1;
+  MotionRange range = MotionRange::Exclusive;
+
+  bool isValid() const { return position >= 0; }
+};
+
+// A text object as typed after an operator's i or a: w, W, p, a bracket or
+// a quote. The kind is null when a command has none.
+struct TextObject {
+  QChar kind;
+  bool inner = false;
+
+  bool isValid() const { return !kind.isNull(); }
+};
+
+// The span an operator works on, end exclusive. Linewise spans run from
+// the start of their first line past the break after their last one, or
+// to the end of the document when that is the last line.
+struct TextRange {
+  int start = -1;
+  int end = -1;
+  bool linewise = false;
+
+  bool isValid() const { return start >= 0 && end >= start; }
+};
+
+// Walks a document one character at a time, a block's text at a time. The
+// end of every block reads as '\n', including the last one, so positions
+// run from 0 to characterCount() - 1 like QTextCursor positions do.
+class TextIterator {
+public:
+  TextIterator(const QTextDocument *document, int position);
+
+  int position() const { return blockStart + offset; }
+  int column() const { return offset; }
+  QChar character() const {
+    return offset < text.size() ? text.at(offset) : QLatin1Char('\n');
+  }
+  const QString &lineText() const { return text; }
+  const QTextBlock &block() const { return currentBlock; }
+  bool atLineStart() const { return offset == 0; }
+  bool atLineEnd() const { return offset == text.size(); }
+  bool lineEmpty() const { return text.isEmpty(); }
+
+  bool next() {
+    if (offset < text.size()) {
+      ++offset;
+      return true;
+    }
+    const QTextBlock following = currentBlock.next();
+    if (!following.isValid())
+      return false;
+    load(following);
+    offset = 0;
+    return true;
+  }
+
+  bool previous() {
+    if (offset > 0) {
+      --offset;
+      return true;
+    }
+    const QTextBlock preceding = currentBlock.previous();
+    if (!preceding.isValid())
+      return false;
+    load(preceding);
+    offset = text.size();
+    return true;
+  }
+
+  void setColumn(int column) { offset = qBound(0, column, text.size()); }
+
+private:
+  void load(const QTextBlock &block);
+
+  QTextBlock currentBlock;
+  QString text;
+  int blockStart = 0;
+  int offset = 0;
+};
+
+// Vim's character classes: blanks (line ends included), punctuation and
+// word characters. For WORD motions everything but blanks is one class.
+enum CharClass { Blank, Punctuation, WordChar };
+CharClass charClass(QChar c, bool bigWord);
+
+// Resolves motions against a document the way Vim does. Targets are where
+// the motion ends for an operator, which can be the end of a line;
+// clampToCharacter() gives where the Normal mode cursor rests instead.
+// Vertical motions keep a preferred column across lines, INT_MAX after $.
+class MotionEngine {
+public:
+  explicit MotionEngine(const QTextDocument *document);
+
+  MotionTarget resolve(const Motion &motion, int position,
+                       int &preferredColumn) const;
+  int clampToCharacter(int position) const;
+
+  // The span an operator covers when moving from `position` to `target`,
+  // with Vim's adjustments for exclusive motions ending in column 0.
+  TextRange motionRange(int position, const MotionTarget &target) const;
+  // `count` lines from the one holding `position`, as dd and yy use them.
+  TextRange lineRange(int position, int count) const;
+  TextRange objectRange(const TextObject &object, int position,
+                        int count) const;
+  // w and W after an operator stop at the end of the line instead of
+  // moving on to the next one; after c, on a word they act like e.
+  MotionTarget operatorWordTarget(const Motion &motion, int position,
+                                  bool change) const;
+
+private:
+  int lineCount() const;
+  int lineTarget(int line, int column) const;
+  int firstNonBlank(const QTextBlock &block) const;
+  TextRange lines(const QTextBlock &first, const QTextBlock &last) const;
+
+  MotionTarget horizontal(const Motion &motion, int position) const;
+  MotionTarget vertical(const Motion &motion, int position,
+                        int &preferredColumn) const;
+  MotionTarget wordForward(int position, int count, bool bigWord,
+                           bool stopAtLineEnd = false) const;
+  MotionTarget wordBackward(int position, int count, bool bigWord) const;
+  MotionTarget wordEnd(int position, int count, bool bigWord,
+                       bool stopAtWordEnd = false) const;
+  MotionTarget matchPair(int position) const;
+  MotionTarget paragraph(int position, int count, bool forward) const;
+  MotionTarget find(const Motion &motion, int position) const;
+  TextRange wordObject(int position, int count, bool inner,
+                       bool bigWord) const;
+  TextRange paragraphObject(int position, int count, bool inner) const;
+  TextRange bracketObject(int position, int count, bool inner, QChar open,
+                          QChar close) const;
+  TextRange quoteObject(int position, bool inner, QChar quote) const;
+
+  const QTextDocument *document;
+};
+
+} // namespace Jino::Editor::Vim
@@ -0,0 +1,540 @@
+#include "editor/vim/vim_parser.hpp"
+#include "editor/vim/vim_registers.hpp"
+
+#include <QKeyEvent>
+
+namespace Jino::Editor::Vim {
+
+namespace {
+// Counts beyond this are clamped; every motion saturates long before.
+constexpr int MAX_COUNT = 999999;
+
+MotionType reversed(MotionType type) {
+  switch (type) {
+  case MotionType::FindForward:
+    return MotionType::FindBackward;
+  case MotionType::FindBackward:
+    return MotionType::FindForward;
+  case MotionType::TillForward:
+    return MotionType::TillBackward;
+  case MotionType::TillBackward:
+    return MotionType::TillForward;
+  default:
+    return type;
+  }
+}
+
+bool isTextObjectKind(QChar c) {
+  return QStringLiteral("wWp()b[]{}B<>\"'`").contains(c);
+}
+
+// Registers a macro can be recorded into; upper case letters append.
+bool isMacroRegister(QChar c) {
+  return c.isLetterOrNumber() && c.unicode() < 128;
+}
+
+struct NamedKey {
+  int key;
+  const char *name;
+};
+
+// Return, Tab and Space are named only when held with a modifier.
+constexpr NamedKey NAMED_KEYS[] = {
+    {Qt::Key_Escape, "Esc"},     {Qt::Key_Return, "CR"},
+    {Qt::Key_Enter, "kEnter"},   {Qt::Key_Tab, "Tab"},
+    {Qt::Key_Space, "Space"},    {Qt::Key_Backspace, "BS"},
+    {Qt::Key_Delete, "Del"},     {Qt::Key_Insert, "Insert"},
+    {Qt::Key_Left, "Left"},      {Qt::Key_Right, "Right"},
+    {Qt::Key_Up, "Up"},          {Qt::Key_Down, "Down"},
+    {Qt::Key_Home, "Home"},      {Qt::Key_End, "End"},
+    {Qt::Key_PageUp, "PageUp"},  {Qt::Key_PageDown, "PageDown"},
+};
+
+KeyStroke characterStroke(QChar c) {
+  if (c == QLatin1Char('\n') || c == QLatin1Char('\r'))
+    return {Qt::Key_Return, Qt::NoModifier, QStringLiteral("\r")};
+  if (c == QLatin1Char('\t'))
+    return {Qt::Key_Tab, Qt::NoModifier, QStringLiteral("\t")};
+  return {int(c.toUpper().unicode()),
+          c.isUpper() ? Qt::ShiftModifier : Qt::NoModifier, QString(c)};
+}
+
+// Reads the inside of <...>, false when it names no key.
+bool namedStroke(QString name, KeyStroke &stroke) {
+  Qt::KeyboardModifiers modifiers = Qt::NoModifier;
+  while (name.size() > 2 && name.at(1) == QLatin1Char('-')) {
+    switch (name.at(0).toUpper().toLatin1()) {
+    case 'C':
+      modifiers |= Qt::ControlModifier;
+      break;
+    case 'A':
+      modifiers |= Qt::AltModifier;
+      break;
+    case 'M':
+      modifiers |= Qt::MetaModifier;
+      break;
+    case 'S':
+      modifiers |= Qt::ShiftModifier;
+      break;
+    default:
+      return false;
+    }
+    name.remove(0, 2);
+  }
+  if (modifiers == Qt::NoModifier &&
+      name.compare(QLatin1String("lt"), Qt::CaseInsensitive) == 0) {
+    stroke = characterStroke(QLatin1Char('<'));
+    return true;
+  }
+  for (const NamedKey &named : NAMED_KEYS) {
+    if (name.compare(QLatin1String(named.name), Qt::CaseInsensitive) != 0)
+      continue;
+    stroke = {named.key, modifiers, QString()};
+    if (!(modifiers & (Qt::ControlModifier | Qt::AltModifier |
+                       Qt::MetaModifier))) {
+      if (named.key == Qt::Key_Return || named.key == Qt::Key_Enter)
+        stroke.text = QStringLiteral("\r");
+      else if (named.key == Qt::Key_Tab)
+        stroke.text = QStringLiteral("\t");
+      else if (named.key == Qt::Key_Space)
+        stroke.text = QStringLiteral(" ");
+    }
+    return true;
+  }
+  // A character is only named together with a modifier, as in <C-r>.
+  if (modifiers == Qt::NoModifier || name.size() != 1 ||
+      name.at(0).unicode() <= ' ' || name.at(0).unicode() >= 127)
+    return false;
+  const QChar c = name.at(0);
+  stroke = {int(c.toUpper().unicode()), modifiers, QString(c)};
+  if (modifiers & Qt::ControlModifier)
+    stroke.text = QChar(c.toUpper().unicode() & 0x1f);
+  return true;
+}
+} // namespace
+
+KeyStroke KeyStroke::fromEvent(const QKeyEvent *event) {
+  return {event->key(), event->modifiers(), event->text()};
+}
+
+QChar KeyStroke::character() const {
+  if (text.size() != 1 || (modifiers & (Qt::ControlModifier | Qt::AltModifier |
+                                        Qt::MetaModifier)))
+    return QChar();
+  return text.at(0);
+}
+
+bool KeyStroke::isModifier() const {
+  switch (key) {
+  case Qt::Key_Shift:
+  case Qt::Key_Control:
+  case Qt::Key_Alt:
+  case Qt::Key_AltGr:
+  case Qt::Key_Meta:
+  case Qt::Key_Super_L:
+  case Qt::Key_Super_R:
+  case Qt::Key_Hyper_L:
+  case Qt::Key_Hyper_R:
+  case Qt::Key_CapsLock:
+    return true;
+  default:
+    return false;
+  }
+}
+
+QString KeyStroke::toText() const {
+  const Qt::KeyboardModifiers chord =
+      modifiers & (Qt::ControlModifier | Qt::AltModifier | Qt::MetaModifier);
+  if (!chord && text.size() == 1) {
+    const QChar c = text.at(0);
+    if (c == QLatin1Char('<'))
+      return QStringLiteral("<lt>");
+    if (c == QLatin1Char('\r'))
+      return QStringLiteral("\n");
+    if (c.isPrint() || c == QLatin1Char('\t'))
+      return text;
+  }
+  QString name;
+  for (const NamedKey &named : NAMED_KEYS) {
+    if (named.key == key)
+      name = QLatin1String(named.name);
+  }
+  if (name.isEmpty()) {
+    if (!chord || key <= Qt::Key_Space || key > Qt::Key_AsciiTilde)
+      return QString();
+    name = QChar(key).toLower();
+  }
+  QString prefix;
+  if (modifiers & Qt::ControlModifier)
+    prefix += QLatin1String("C-");
+  if (modifiers & Qt::AltModifier)
+    prefix += QLatin1String("A-");
+  if (modifiers & Qt::MetaModifier)
+    prefix += QLatin1String("M-");
+  if (modifiers & Qt::ShiftModifier)
+    prefix += QLatin1String("S-");
+  return QLatin1Char('<') + prefix + name + QLatin1Char('>');
+}
+
+// Text that only looks like a key name, such as a lone < or <a>, stays
+// text.
+QVector<KeyStroke> KeyStroke::fromText(const QString &text) {
+  QVector<KeyStroke> strokes;
+  for (int i = 0; i < text.size(); ++i) {
+    if (text.at(i) == QLatin1Char('<')) {
+      const int close = text.indexOf(QLatin1Char('>'), i + 1);
+      KeyStroke stroke;
+      if (close > i + 1 &&
+          namedStroke(text.mid(i + 1, close - i - 1), stroke)) {
+        strokes.append(stroke);
+        i = close;
+        continue;
+      }
+    }
+    strokes.append(characterStroke(text.at(i)));
+  }
+  return strokes;
+}
+
+CommandParser::Status CommandParser::feed(const KeyStroke &stroke,
+                                          bool visual) {
+  // The Shift before a shifted key arrives as a press of its own and must
+  // not break off a count, an operator or an f/t argument.
+  if (stroke.isModifier())
+    return Status::Pending;
+  const QChar c = stroke.character();
+  if (!prefix.isNull())
+    return feedPrefix(c);
+
+  if (c.isDigit() && (c != QLatin1Char('0') || count > 0)) {
+    count = qMin(MAX_COUNT, count * 10 + c.digitValue());
+    return Status::Pending;
+  }
+
+  switch (stroke.key) {
+  case Qt::Key_Left:
+    return complete(MotionType::Left);
+  case Qt::Key_Right:
+    return complete(MotionType::Right);
+  case Qt::Key_Up:
+    return complete(MotionType::Up);
+  case Qt::Key_Down:
+    return complete(MotionType::Down);
+  case Qt::Key_Home:
+    return complete(MotionType::LineStart);
+  case Qt::Key_End:
+    return complete(MotionType::LineEnd);
+  default:
+    break;
+  }
+
+  if (pendingOperator != Operator::None) {
+    if (c == operatorKey)
+      return completeLines();
+    if (c == QLatin1Char('i') || c == QLatin1Char('a')) {
+      prefix = c;
+      return Status::Pending;
+    }
+  } else if (c == QLatin1Char('"')) {
+    prefix = c;
+    return Status::Pending;
+  } else if (visual) {
+    const Status status = feedVisualOperator(c);
+    if (status != Status::Rejected)
+      return status;
+  } else {
+    switch (c.unicode()) {
+    case 'd':
+    case 'c':
+    case 'y':
+    case '>':
+    case '<':
+      return feedOperatorKey(c);
+    case 'x':
+      return completeShortcut(Operator::Delete, MotionType::Right);
+    case 'X':
+      return completeShortcut(Operator::Delete, MotionType::Left);
+    case 'D':
+      return completeShortcut(Operator::Delete, MotionType::LineEnd);
+    case 'C':
+      return completeShortcut(Operator::Change, MotionType::LineEnd);
+    case 's':
+      return completeShortcut(Operator::Change, MotionType::Right);
+    case 'S':
+      return completeShortcut(Operator::Change, MotionType::None, true);
+    case 'Y':
+      return completeShortcut(Operator::Yank, MotionType::None, true);
+    case 'p':
+      return completePut(Put::After);
+    case 'P':
+      return completePut(Put::Before);
+    case '.':
+      return completeRepeat();
+    case 'q':
+    case '@':
+      prefix = c;
+      return Status::Pending;
+    default:
+      break;
+    }
+  }
+
+  switch (c.unicode()) {
+  case 'h':
+    return complete(MotionType::Left);
+  case 'l':
+    return complete(MotionType::Right);
+  case 'k':
+    return complete(MotionType::Up);
+  case 'j':
+    return complete(MotionType::Down);
+  case '0':
+    return complete(MotionType::LineStart);
+  case '^':
+    return complete(MotionType::FirstNonBlank);
+  case '$':
+    return complete(MotionType::LineEnd);
+  case 'w':
+    return complete(MotionType::WordForward);
+  case 'b':
+    return complete(MotionType::WordBackward);
+  case 'e':
+    return complete(MotionType::WordEnd);
+  case 'W':
+    return complete(MotionType::BigWordForward);
+  case 'B':
+    return complete(MotionType::BigWordBackward);
+  case 'E':
+    return complete(MotionType::BigWordEnd);
+  case 'G':
+    return complete(MotionType::LastLine);
+  case '%':
+    return complete(MotionType::MatchPair);
+  case '}':
+    return complete(MotionType::ParagraphForward);
+  case '{':
+    return complete(MotionType::ParagraphBackward);
+  case ';':
+    return repeatFind(false);
+  case ',':
+    return repeatFind(true);
+  case 'g':
+  case 'f':
+  case 't':
+  case 'F':
+  case 'T':
+    prefix = c;
+    return Status::Pending;
+  default:
+    break;
+  }
+  if (pendingOperator != Operator::None)
+    return cancel();
+  reset();
+  return Status::Rejected;
+}
+
+const Command &CommandParser::command() const { return parsed; }
+
+bool CommandParser::isPending() const {
+  return count > 0 || pendingOperator != Operator::None || !prefix.isNull() ||
+         !registerName.isNull();
+}
+
+void CommandParser::reset() {
+  count = 0;
+  operatorCount = 0;
+  pendingOperator = Operator::None;
+  operatorKey = QChar();
+  prefix = QChar();
+  registerName = QChar();
+}
+
+CommandParser::Status CommandParser::feedPrefix(QChar c) {
+  const QChar pending = prefix;
+  prefix = QChar();
+  if (c.isNull())
+    return cancel();
+  switch (pending.unicode()) {
+  case 'g':
+    if (c == QLatin1Char('g'))
+      return complete(MotionType::FirstLine);
+    break;
+  case 'f':
+    return complete(MotionType::FindForward, c);
+  case 't':
+    return complete(MotionType::TillForward, c);
+  case 'F':
+    return complete(MotionType::FindBackward, c);
+  case 'T':
+    return complete(MotionType::TillBackward, c);
+  case 'i':
+  case 'a':
+    if (isTextObjectKind(c))
+      return completeObject(c, pending == QLatin1Char('i'));
+    break;
+  case '"':
+    if (Registers::isValidName(c)) {
+      registerName = c;
+      return Status::Pending;
+    }
+    break;
+  case 'q':
+    if (isMacroRegister(c))
+      return completeMacro(MacroAction::Record, c);
+    break;
+  case '@':
+    if (Registers::isValidName(c) || c == QLatin1Char('@'))
+      return completeMacro(MacroAction::Replay, c);
+    break;
+  default:
+    break;
+  }
+  return cancel();
+}
+
+CommandParser::Status CommandParser::feedOperatorKey(QChar c) {
+  switch (c.unicode()) {
+  case 'd':
+    pendingOperator = Operator::Delete;
+    break;
+  case 'c':
+    pendingOperator = Operator::Change;
+    break;
+  case 'y':
+    pendingOperator = Operator::Yank;
+    break;
+  case '>':
+    pendingOperator = Operator::ShiftRight;
+    break;
+  default:
+    pendingOperator = Operator::ShiftLeft;
+    break;
+  }
+  operatorKey = c;
+  operatorCount = count;
+  count = 0;
+  return Status::Pending;
+}
+
+// Visual mode operators apply to the selection straight away; the upper
+// case ones to all of its lines.
+CommandParser::Status CommandParser::feedVisualOperator(QChar c) {
+  switch (c.unicode()) {
+  case 'd':
+  case 'x':
+    return completeShortcut(Operator::Delete, MotionType::None);
+  case 'D':
+  case 'X':
+    return completeShortcut(Operator::Delete, MotionType::None, true);
+  case 'c':
+  case 's':
+    return completeShortcut(Operator::Change, MotionType::None);
+  case 'C':
+  case 'S':
+    return completeShortcut(Operator::Change, MotionType::None, true);
+  case 'y':
+    return completeShortcut(Operator::Yank, MotionType::None);
+  case 'Y':
+    return completeShortcut(Operator::Yank, MotionType::None, true);
+  case '>':
+    return completeShortcut(Operator::ShiftRight, MotionType::None);
+  case '<':
+    return completeShortcut(Operator::ShiftLeft, MotionType::None);
+  default:
+    return Status::Rejected;
+  }
+}
+
+void CommandParser::startCommand(Operator op) {
+  parsed = Command();
+  parsed.op = op;
+  parsed.registerName = registerName;
+}
+
+CommandParser::Status CommandParser::complete(MotionType type,
+                                              QChar argument) {
+  startCommand(pendingOperator);
+  parsed.motion = {type, totalCount(), argument};
+  if (!argument.isNull())
+    lastFind = parsed.motion;
+  reset();
+  return Status::Complete;
+}
+
+CommandParser::Status CommandParser::completeObject(QChar kind, bool inner) {
+  startCommand(pendingOperator);
+  parsed.motion.count = totalCount();
+  parsed.object = {kind, inner};
+  reset();
+  return Status::Complete;
+}
+
+CommandParser::Status CommandParser::completeLines() {
+  return completeShortcut(pendingOperator, MotionType::None, true);
+}
+
+CommandParser::Status CommandParser::completeShortcut(Operator op,
+                                                      MotionType type,
+                                                      bool lines) {
+  startCommand(op);
+  parsed.motion = {type, totalCount(), QChar()};
+  parsed.lines = lines;
+  reset();
+  return Status::Complete;
+}
+
+CommandParser::Status CommandParser::completeMacro(MacroAction action,
+                                                   QChar name) {
+  startCommand(Operator::None);
+  parsed.motion.count = totalCount();
+  parsed.macro = action;
+  parsed.registerName = name;
+  reset();
+  return Status::Complete;
+}
+
+CommandParser::Status CommandParser::completePut(Put put) {
+  startCommand(Operator::None);
+  parsed.motion.count = totalCount();
+  parsed.put = put;
+  reset();
+  return Status::Complete;
+}
+
+CommandParser::Status CommandParser::completeRepeat() {
+  startCommand(Operator::None);
+  parsed.motion.count = totalCount();
+  parsed.repeat = true;
+  reset();
+  return Status::Complete;
+}
+
+CommandParser::Status CommandParser::repeatFind(bool reverse) {
+  if (lastFind.type == MotionType::None) {
+    if (pendingOperator != Operator::None)
+      return cancel();
+    reset();
+    return Status::Rejected;
+  }
+  // Repeating does not change the direction remembered for the next ; or ,.
+  const Motion find = lastFind;
+  const Status status =
+      complete(reverse ? reversed(find.type) : find.type, find.argument);
+  lastFind = find;
+  return status;
+}
+
+CommandParser::Status CommandParser::cancel() {
+  reset();
+  return Status::Cancelled;
+}
+
+int CommandParser::totalCount() const {
+  if (count == 0 && operatorCount == 0)
+    return 0;
+  return int(qMin<qint64>(MAX_COUNT, qint64(qMax(1, operatorCount)) *
+                                         qMax(1, count)));
+}
+
+} // namespace Jino::Editor::Vim
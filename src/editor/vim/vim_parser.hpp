@@ -0,0 +1,99 @@
+// src/editor/vim/vim_parser.hpp
+#pragma once
+
+#include "editor/vim/vim_motion.hpp"
+
+#include <QString>
+#include <QVector>
+#include <Qt>
+
+class QKeyEvent;
+
+namespace Jino::Editor::Vim {
+
+// A key press reduced to what the parser looks at.
+struct KeyStroke {
+  int key = 0;
+  Qt::KeyboardModifiers modifiers = Qt::NoModifier;
+  QString text;
+
+  static KeyStroke fromEvent(const QKeyEvent *event);
+  // The typed character for plain keys, a null QChar otherwise.
+  QChar character() const;
+  // Shift, Control, Alt and the like pressed on their own.
+  bool isModifier() const;
+
+  // Keys as register text, so macros and yanked text share registers: keys
+  // that type text are that text, Return a line break, < is <lt> and other
+  // keys are named as in Vim (<Esc>, <BS>, <C-r>). Keys without a name or
+  // text, such as function keys, are left out.
+  QString toText() const;
+  static QVector<KeyStroke> fromText(const QString &text);
+};
+
+enum class Operator { None, Delete, Change, Yank, ShiftRight, ShiftLeft };
+enum class MacroAction { None, Record, Replay };
+enum class Put { None, After, Before };
+
+// A complete command: a motion on its own, or an operator together with
+// the motion or text object it applies to. A doubled operator (dd, >>)
+// works on count whole lines. Counts typed before and after the operator
+// are multiplied into the motion's count. p and P put a register count
+// times and [count]. repeats the last change; q{register} and
+// [count]@{register} record and replay macros, with @@ naming the register
+// as '@'. A register typed as "x comes first. In
+// Visual mode an operator has neither motion nor object and applies to the
+// selection, to its whole lines when `lines` is set.
+struct Command {
+  Operator op = Operator::None;
+  Motion motion;
+  TextObject object;
+  bool lines = false;
+  Put put = Put::None;
+  bool repeat = false;
+  MacroAction macro = MacroAction::None;
+  QChar registerName;
+};
+
+// Collects Normal and Visual mode keys into commands following Vim's
+// grammar: [count] motion, or [count] operator [count] followed by a
+// motion, a text object (iw, a") or the operator again. Keys that do not
+// start a command are rejected and leave the parser empty, so the caller
+// can handle them itself; a key that breaks off a started command cancels
+// it. The last f, t, F or T is remembered for ; and ,.
+class CommandParser {
+public:
+  enum class Status { Rejected, Pending, Complete, Cancelled };
+
+  Status feed(const KeyStroke &stroke, bool visual = false);
+  const Command &command() const;
+  bool isPending() const;
+  void reset();
+
+private:
+  Status feedPrefix(QChar c);
+  Status feedOperatorKey(QChar c);
+  Status feedVisualOperator(QChar c);
+  void startCommand(Operator op);
+  Status complete(MotionType type, QChar argument = QChar());
+  Status completeObject(QChar kind, bool inner);
+  Status completeLines();
+  Status completeShortcut(Operator op, MotionType type, bool lines = false);
+  Status completeMacro(MacroAction action, QChar name);
+  Status completePut(Put put);
+  Status completeRepeat();
+  Status repeatFind(bool reverse);
+  Status cancel();
+  int totalCount() const;
+
+  int count = 0;
+  int operatorCount = 0;
+  Operator pendingOperator = Operator::None;
+  QChar operatorKey;
+  QChar prefix;
+  QChar registerName;
+  Command parsed;
+  Motion lastFind;
+};
+
+} // namespace Jino::Editor::Vim
@@ -0,0 +1,103 @@
+#include "editor/vim/vim_registers.hpp"
+
+#include <QApplication>
+#include <QClipboard>
+
+namespace Jino::Editor::Vim {
+
+namespace {
+const QChar UNNAMED = QLatin1Char('"');
+
+bool isClipboard(QChar name) {
+  return name == QLatin1Char('+') || name == QLatin1Char('*');
+}
+
+// * is the primary selection where the platform has one.
+QClipboard::Mode clipboardMode(QChar name) {
+  return name == QLatin1Char('*') &&
+                 QApplication::clipboard()->supportsSelection()
+             ? QClipboard::Selection
+             : QClipboard::Clipboard;
+}
+} // namespace
+
+Registers &Registers::instance() {
+  static Registers registers;
+  return registers;
+}
+
+bool Registers::isValidName(QChar name) {
+  if (name.unicode() >= 128)
+    return false;
+  return name.isLetterOrNumber() || QStringLiteral("\"-_+*").contains(name);
+}
+
+Register Registers::get(QChar name) const {
+  if (name.isNull())
+    name = UNNAMED;
+  if (isClipboard(name)) {
+    const QString text = QApplication::clipboard()->text(clipboardMode(name));
+    return {text, text.endsWith(QLatin1Char('\n'))};
+  }
+  return registers.value(name.toLower());
+}
+
+void Registers::yank(QChar name, const Register &contents) {
+  if (store(name, contents))
+    return;
+  registers.insert(QLatin1Char('0'), contents);
+  registers.insert(UNNAMED, contents);
+}
+
+// Deleted lines push the older ones down 1 to 9; deletes within a line go
+// to - instead.
+void Registers::remove(QChar name, const Register &contents) {
+  if (store(name, contents))
+    return;
+  if (contents.linewise || contents.text.contains(QLatin1Char('\n'))) {
+    for (char n = '9'; n > '1'; --n)
+      registers.insert(QLatin1Char(n),
+                       registers.value(QLatin1Char(char(n - 1))));
+    registers.insert(QLatin1Char('1'), contents);
+  } else {
+    registers.insert(QLatin1Char('-'), contents);
+  }
+  registers.insert(UNNAMED, contents);
+}
+
+void Registers::record(QChar name, const QString &keys) {
+  Register &target = registers[name.toLower()];
+  if (name.isUpper())
+    target.text += keys;
+  else
+    target = {keys, false};
+}
+
+// Stores into the register the command named, false when it named none.
+// The unnamed register follows whatever was written last.
+bool Registers::store(QChar name, const Register &contents) {
+  if (name.isNull() || name == UNNAMED)
+    return false;
+  if (name == QLatin1Char('_'))
+    return true;
+  if (isClipboard(name)) {
+    QApplication::clipboard()->setText(contents.text, clipboardMode(name));
+    registers.insert(UNNAMED, contents);
+    return true;
+  }
+  Register &target = registers[name.toLower()];
+  if (name.isUpper() && !target.isEmpty()) {
+    // Appending lines to text starts them on a line of their own.
+    if (contents.linewise && !target.text.endsWith(QLatin1Char('\n')))
+      target.text += QLatin1Char('\n');
+    target.text += contents.text;
+    target.linewise = target.linewise || contents.linewise;
+  } else {
+    target = contents;
+  }
+  const Register stored = target;
+  registers.insert(UNNAMED, stored);
+  return true;
+}
+
+} // namespace Jino::Editor::Vim
@@ -0,0 +1,48 @@
+// src/editor/vim/vim_registers.hpp
+#pragma once
+
+#include <QChar>
+#include <QHash>
+#include <QString>
+
+namespace Jino::Editor::Vim {
+
+// Register contents: the text with '\n' line breaks, and whether it was
+// taken as whole lines, in which case it ends in a line break.
+struct Register {
+  QString text;
+  bool linewise = false;
+
+  bool isEmpty() const { return text.isEmpty(); }
+};
+
+// Vim's registers, shared by every editor and held in process: the unnamed
+// register ("), the yank register (0), the delete history (1 to 9), small
+// deletes (-), the named registers (a to z, A to Z appends) and the black
+// hole (_). Macros are recorded into the same registers, as their keys
+// spelled out in text, so a recorded macro can be put and yanked text
+// replayed with @. Registers share their text implicitly, so a yank stored
+// in several of them, or put many times, is never copied; only + and * go
+// through the system clipboard. GUI thread only.
+class Registers {
+public:
+  static Registers &instance();
+  static bool isValidName(QChar name);
+
+  // `name` is null when none was given.
+  Register get(QChar name) const;
+  void yank(QChar name, const Register &contents);
+  void remove(QChar name, const Register &contents);
+  // `name` is a letter or digit. Unlike a yank, a recording leaves the
+  // unnamed register alone.
+  void record(QChar name, const QString &keys);
+
+private:
+  Registers() = default;
+
+  bool store(QChar name, const Register &contents);
+
+  QHash<QChar, Register> registers;
+};
+
+} // namespace Jino::Editor::Vim
@@ -1,5 +1,6 @@
 #include "QtAwesome.h"
 #include "app/jino_editor.hpp"
+#include "app/single_instance.hpp"
 #include "core/constants.hpp"
 
 #include <QApplication>
@@ -8,29 +9,78 @@
 #include <QCommandLineParser>
 #include <QDebug>
 #include <QDir>
-#include <QFile>
 #include <QFileInfo>
 #include <QPalette>
 #include <QSettings>
 #include <QStringList>
 #include <QStyleFactory>
-#include <QTextStream>
-
-QString loadStyleSheetFromResource(const QString &themeName) {
-  QString resourcePath = QString(":/themes/%1.qss").arg(themeName);
-  QFile f(resourcePath);
-  if (!f.open(QFile::ReadOnly | QFile::Text)) {
-    qWarning() << "Could not load theme file:" << resourcePath;
-    return QString();
+
+struct CommandLineOptions {
+  QString windowTitleOverride;
+  QString windowClassHint;
+  bool singleInstance = false;
+  QStringList filesToOpen;
+};
+
+CommandLineOptions parseCommandLine(const QCoreApplication &app) {
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Jino Text Editor - Minimalist editor with Vim modes.");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  QCommandLineOption nameOption(QStringList() << "n" << "name", "Program name.",
+                                "name");
+  parser.addOption(nameOption);
+  QCommandLineOption classOption(QStringList() << "c" << "class",
+                                 "Program class.", "class");
+  parser.addOption(classOption);
+  QCommandLineOption singleInstanceOption(
+      QStringList() << "s" << "single-instance",
+      "Open files in the already running instance, if any.");
+  parser.addOption(singleInstanceOption);
+  parser.addPositionalArgument("files", "Files to open.", "[files...]");
+  parser.process(app);
+
+  CommandLineOptions options;
+  options.windowTitleOverride = parser.value(nameOption);
+  options.windowClassHint = parser.value(classOption);
+  options.singleInstance =
+      parser.isSet(singleInstanceOption) ||
+      QSettings(Jino::Constants::APP_ORGANIZATION_NAME,
+                Jino::Constants::APP_APPLICATION_NAME)
+          .value(Jino::Constants::SETTINGS_KEY_SINGLE_INSTANCE, false)
+          .toBool();
+  options.filesToOpen = parser.positionalArguments();
+  return options;
+}
+
+bool singleInstanceRequested(int argc, char *argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    const QByteArray arg(argv[i]);
+    if (arg == "-s" || arg == "--single-instance")
+      return true;
   }
-  QTextStream ts(&f);
-  return ts.readAll();
+  return QSettings(Jino::Constants::APP_ORGANIZATION_NAME,
+                   Jino::Constants::APP_APPLICATION_NAME)
+      .value(Jino::Constants::SETTINGS_KEY_SINGLE_INSTANCE, false)
+      .toBool();
 }
 
 int main(int argc, char *argv[]) {
   QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
   QApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
 
+  if (singleInstanceRequested(argc, argv)) {
+    // Hand the files to a running instance before paying for QApplication,
+    // fonts and themes.
+    QCoreApplication probe(argc, argv);
+    QCoreApplication::setApplicationVersion(Jino::Constants::APP_VERSION);
+    const CommandLineOptions options = parseCommandLine(probe);
+    if (Jino::App::SingleInstance::sendToRunningInstance(
+            options.filesToOpen))
+      return 0;
+  }
+
   QApplication app(argc, argv);
   QApplication::setOrganizationName(Jino::Constants::APP_ORGANIZATION_NAME);
   QApplication::setApplicationName(Jino::Constants::APP_APPLICATION_NAME);
@@ -52,23 +102,10 @@ int main(int argc, char *argv[]) {
                << Jino::Constants::DEFAULT_NOTES_DIR;
   }
 
-  QCommandLineParser parser;
-  parser.setApplicationDescription(
-      "Jino Text Editor - Minimalist editor with Vim modes.");
-  parser.addHelpOption();
-  parser.addVersionOption();
-  QCommandLineOption nameOption(QStringList() << "n" << "name", "Program name.",
-                                "name");
-  parser.addOption(nameOption);
-  QCommandLineOption classOption(QStringList() << "c" << "class",
-                                 "Program class.", "class");
-  parser.addOption(classOption);
-  parser.addPositionalArgument("files", "Files to open.", "[files...]");
-  parser.process(app);
-
-  QString windowTitleOverride = parser.value(nameOption);
-  QString windowClassHint = parser.value(classOption);
-  QStringList filesToOpen = parser.positionalArguments();
+  const CommandLineOptions options = parseCommandLine(app);
+  const QString &windowTitleOverride = options.windowTitleOverride;
+  const QString &windowClassHint = options.windowClassHint;
+  const QStringList &filesToOpen = options.filesToOpen;
 
   QSettings settings;
   int lastWorkspaceIndex =
@@ -81,10 +118,6 @@ int main(int argc, char *argv[]) {
   settings.setValue(Jino::Constants::SETTINGS_KEY_WORKSPACE_INDEX,
                     nextWorkspaceIndex);
 
-  QString selectedTheme = Jino::Constants::DEFAULT_THEME;
-  QString styleSheet = loadStyleSheetFromResource(selectedTheme);
-  app.setStyleSheet(styleSheet);
-
   QPalette palette = QApplication::palette();
   palette.setColor(QPalette::Window, QColor("#2f383e"));
   palette.setColor(QPalette::WindowText, everforestText);
@@ -105,13 +138,29 @@ int main(int argc, char *argv[]) {
   QGuiApplication::setDesktopFileName(desktopBaseName + ".desktop");
 
   Jino::App::JinoEditor window(nullptr, currentWorkspaceName, awesome);
+  window.applyTheme(settings
+                        .value(Jino::Constants::SETTINGS_KEY_THEME,
+                               Jino::Constants::DEFAULT_THEME)
+                        .toString());
 
   if (!windowTitleOverride.isEmpty()) {
     window.setWindowTitle(windowTitleOverride);
   }
 
+  window.recoverJournals();
   window.openFilesFromCli(filesToOpen);
 
+  Jino::App::SingleInstance singleInstance;
+  if (options.singleInstance && singleInstance.listen()) {
+    QObject::connect(&singleInstance,
+                     &Jino::App::SingleInstance::filesReceived, &window,
+                     [&window](const QStringList &filePaths) {
+                       window.openFilesFromCli(filePaths);
+                       window.raise();
+                       window.activateWindow();
+                     });
+  }
+
   window.show();
 
   int exitCode = app.exec();